@@ -0,0 +1,158 @@
+// BRIDGE hosted benchmark runner.
+//
+//   bridge-bench [-v] [filter]
+//
+// -v echoes console output from the code under test.
+// Runs each benchmark whose name contains filter, doubling the iteration
+// count until a run takes at least BENCH_MIN_NS, then reports ns/op.
+
+#include "hosted.h"
+
+extern int sprintf(char *buf, const char *fmt, ...);
+extern int strlen(const char *s);
+
+// bench_lib.c
+extern void bench_strlen(int n);
+extern void bench_strcmp(int n);
+extern void bench_strcpy(int n);
+extern void bench_concat_strings(int n);
+extern void bench_sprintf(int n);
+extern void bench_char_class(int n);
+extern void bench_str_lower(int n);
+extern void bench_string_builder(int n);
+extern void bench_intern(int n);
+extern void bench_malloc(int n);
+extern void bench_normalize_path(int n);
+extern void bench_set_cwd(int n);
+extern void bench_list_dir(int n);
+extern void bench_read_file(int n);
+extern void bench_env_argv(int n);
+
+// bench_shell.c
+extern void bench_parse_input(int n);
+extern void bench_exec_builtin(int n);
+extern void bench_exec_external(int n);
+extern void bench_exec_pipeline(int n);
+extern void bench_exec_redirect(int n);
+extern void bench_session(int n);
+extern void bench_script(int n);
+extern int bench_session_lines(void);
+
+#define BENCH_MIN_NS 100000000ull   // 100 ms per measurement
+#define BENCH_MAX_ITERS (1 << 26)
+
+struct bench_case {
+    const char *name;
+    void (*fn)(int n);
+    int ops_per_iter;   // e.g. command lines per session
+};
+
+static const struct bench_case bench_cases[] = {
+    { "lib/strlen",          bench_strlen,          1 },
+    { "lib/strcmp",          bench_strcmp,          1 },
+    { "lib/strcpy",          bench_strcpy,          1 },
+    { "lib/concat_strings",  bench_concat_strings,  1 },
+    { "lib/sprintf",         bench_sprintf,         1 },
+    { "lib/char_class",      bench_char_class,      1 },
+    { "lib/str_lower",       bench_str_lower,       1 },
+    { "lib/string_builder",  bench_string_builder,  1 },
+    { "lib/intern",          bench_intern,          1 },
+    { "lib/malloc",          bench_malloc,          1 },
+    { "lib/normalize_path",  bench_normalize_path,  1 },
+    { "lib/set_cwd",         bench_set_cwd,         1 },
+    { "lib/list_dir",        bench_list_dir,        1 },
+    { "lib/read_file",       bench_read_file,       1 },
+    { "lib/env_argv",        bench_env_argv,        1 },
+    { "shell/parse_input",   bench_parse_input,     1 },
+    { "shell/exec_builtin",  bench_exec_builtin,    1 },
+    { "shell/exec_external", bench_exec_external,   1 },
+    { "shell/exec_pipeline", bench_exec_pipeline,   1 },
+    { "shell/exec_redirect", bench_exec_redirect,   1 },
+    { "shell/session",       bench_session,         0 },
+    { "shell/script",        bench_script,          0 },
+};
+
+static int str_contains(const char *s, const char *needle) {
+    int n = strlen(needle);
+    for (int i = 0; s[i]; i++) {
+        int j = 0;
+        while (j < n && s[i + j] == needle[j]) j++;
+        if (j == n) return 1;
+    }
+    return n == 0;
+}
+
+static void print_padded(const char *s, int width, int right) {
+    int len = strlen(s);
+    if (right) for (int i = len; i < width; i++) hosted_write(1, " ", 1);
+    hosted_write(1, s, len);
+    if (!right) for (int i = len; i < width; i++) hosted_write(1, " ", 1);
+}
+
+static void bench_fixture(void) {
+    static const char *apps[] = { "cat", "true", "grep", "wc", "touch", "rm", 0 };
+    char path[64];
+    hosted_fs_reset();
+    hosted_sched_reset();
+    hosted_fs_mkdir("/tmp");
+    hosted_fs_mkdir("/users/root");
+    for (int i = 0; apps[i]; i++) {
+        sprintf(path, "/apps/%s", apps[i]);
+        hosted_fs_write(path, "\x7f" "ELF", 4);
+    }
+    for (int i = 0; i < 64; i++) {
+        sprintf(path, "/data/file_%d.txt", i);
+        hosted_fs_write(path, "x", 1);
+    }
+    static char notes[2048];
+    for (int i = 0; i < (int)sizeof(notes) - 1; i++) {
+        notes[i] = (i % 64 == 63) ? '\n' : "bridge hosted bench "[i % 20];
+    }
+    notes[sizeof(notes) - 1] = '\0';
+    hosted_fs_write("/data/notes.txt", notes, sizeof(notes) - 1);
+    hosted_fs_write("/data/out.txt", "", 0);
+}
+
+static void bench_run(const struct bench_case *bc) {
+    int n = 1;
+    uint64_t elapsed;
+    for (;;) {
+        uint64_t start = hosted_now_ns();
+        bc->fn(n);
+        elapsed = hosted_now_ns() - start;
+        if (elapsed >= BENCH_MIN_NS || n >= BENCH_MAX_ITERS) break;
+        n *= 2;
+    }
+
+    int ops_per_iter = bc->ops_per_iter ? bc->ops_per_iter : bench_session_lines();
+    uint64_t ops = (uint64_t)n * ops_per_iter;
+    uint64_t tenth_ns = elapsed * 10 / ops;
+    uint64_t per_sec = ops * 1000000000ull / (elapsed ? elapsed : 1);
+
+    char num[32];
+    print_padded(bc->name, 24, 0);
+    sprintf(num, "%d", (int)ops);
+    print_padded(num, 10, 1);
+    hosted_puts(" ops");
+    sprintf(num, "%d.%d", (int)(tenth_ns / 10), (int)(tenth_ns % 10));
+    print_padded(num, 12, 1);
+    hosted_puts(" ns/op");
+    sprintf(num, "%d", (int)per_sec);
+    print_padded(num, 12, 1);
+    hosted_puts(" ops/s\n");
+}
+
+int hosted_main(int argc, char **argv) {
+    int arg = 1;
+    if (arg < argc && argv[arg][0] == '-' && argv[arg][1] == 'v') {
+        hosted_console_echo(1);
+        arg++;
+    }
+    const char *filter = arg < argc ? argv[arg] : "";
+    bench_fixture();
+    for (unsigned i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        if (!str_contains(bench_cases[i].name, filter)) continue;
+        bench_run(&bench_cases[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Microbenchmarks for lib.c primitives. lib.c is included directly so
+// static helpers such as normalize_path() can be measured as-is.
+
+#include "../lib.c"
+#include "hosted.h"
+
+static volatile int bench_sink;
+
+// Read inputs through volatile pointers so loops are not hoisted away
+static const char *volatile bench_short = "apps";
+static const char *volatile bench_long =
+    "/users/root/projects/bridge/build/hosted/objects/bench_lib.o";
+static const char *volatile bench_long_b =
+    "/users/root/projects/bridge/build/hosted/objects/bench_lib.c";
+static const char *volatile bench_messy =
+    "/users/./root//projects/../projects/bridge/./build/../src/lib.c";
+
+void bench_strlen(int n) {
+    for (int i = 0; i < n; i++) bench_sink += strlen(bench_long);
+}
+
+void bench_strcmp(int n) {
+    for (int i = 0; i < n; i++) bench_sink += strcmp(bench_long, bench_long_b);
+}
+
+void bench_strcpy(int n) {
+    char buf[VFS_MAX_PATH];
+    for (int i = 0; i < n; i++) {
+        strcpy(buf, bench_long);
+        bench_sink += buf[3];
+    }
+}
+
+void bench_concat_strings(int n) {
+    for (int i = 0; i < n; i++) {
+        if ((i & 63) == 0) heap_reset();
+        bench_sink += concat_strings(bench_long, bench_short)[0];
+    }
+    heap_reset();
+}
+
+void bench_sprintf(int n) {
+    char buf[128];
+    for (int i = 0; i < n; i++) {
+        bench_sink += sprintf(buf, "%s: %d bytes in %d allocs", bench_short, i, i & 255);
+    }
+}
+
+void bench_char_class(int n) {
+    const char *s = bench_long;
+    for (int i = 0; i < n; i++) {
+        int words = 0;
+        for (int j = 0; s[j]; j++) words += char_isword(char_at(s, j));
+        bench_sink += words;
+    }
+}
+
+void bench_str_lower(int n) {
+    for (int i = 0; i < n; i++) {
+        if ((i & 63) == 0) heap_reset();
+        bench_sink += str_lower(bench_long)[0];
+    }
+    heap_reset();
+}
+
+// echo-style output: 64 words joined with spaces
+void bench_string_builder(int n) {
+    for (int i = 0; i < n; i++) {
+        heap_reset();
+        struct strbuf* sb = sb_new(16);
+        for (int j = 0; j < 64; j++) {
+            if (j) sb_append_char(sb, ' ');
+            sb_append(sb, bench_short);
+        }
+        bench_sink += sb_length(sb);
+    }
+    heap_reset();
+}
+
+// Lookup of an existing name with a few hundred names interned
+void bench_intern(int n) {
+    static char names[256][8];
+    if (intern_count_names() < 256) {
+        for (int i = 0; i < 256; i++) {
+            sprintf(names[i], "VAR%d", i);
+            intern(names[i]);
+        }
+    }
+    for (int i = 0; i < n; i++) bench_sink += intern(names[i & 255]);
+}
+
+void bench_malloc(int n) {
+    for (int i = 0; i < n; i++) {
+        if ((i & 1023) == 0) heap_reset();
+        bench_sink += (int)(long)malloc(24 + (i & 31));
+    }
+    heap_reset();
+}
+
+void bench_normalize_path(int n) {
+    char out[VFS_MAX_PATH];
+    for (int i = 0; i < n; i++) {
+        bench_sink += normalize_path(bench_messy, out, VFS_MAX_PATH);
+    }
+}
+
+void bench_set_cwd(int n) {
+    for (int i = 0; i < n; i++) {
+        bench_sink += set_cwd((i & 1) ? "/data" : "..");
+    }
+    set_cwd("/");
+}
+
+void bench_list_dir(int n) {
+    for (int i = 0; i < n; i++) {
+        heap_reset();
+        bench_sink += list_dir("/data")[0];
+    }
+    heap_reset();
+}
+
+void bench_read_file(int n) {
+    for (int i = 0; i < n; i++) {
+        heap_reset();
+        bench_sink += read_file("/data/notes.txt")[0];
+    }
+    heap_reset();
+}
+
+// A steady environment: only the argument pointers are copied per spawn
+void bench_env_argv(int n) {
+    static char *argv[] = { "cat", "/data/notes.txt", 0 };
+    for (int i = 0; i < 8; i++) {
+        char name[16];
+        sprintf(name, "VAR_%d", i);
+        env_set(name, bench_long);
+    }
+    for (int i = 0; i < n; i++) {
+        bench_sink += env_argv(argv)[0][0];
+    }
+}
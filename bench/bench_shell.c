@@ -0,0 +1,92 @@
+// Benchmarks for shell.c command handling. shell.c is included directly
+// so its static parser and executors can be driven without the editor.
+
+#include "../shell.c"
+#include "hosted.h"
+
+extern void heap_reset(void);
+
+static volatile int bench_sink;
+static char bench_line[512];
+
+static void bench_set_line(const char *s) {
+    int i = 0;
+    while (s[i] && i < 511) { bench_line[i] = s[i]; i++; }
+    bench_line[i] = '\0';
+}
+
+void bench_parse_input(int n) {
+    for (int i = 0; i < n; i++) {
+        parse_input("  grep -n pattern /data/notes.txt /data/file_12.txt");
+        bench_sink += cmd_buf[0] + args_buf[0];
+    }
+}
+
+void bench_exec_builtin(int n) {
+    for (int i = 0; i < n; i++) {
+        bench_set_line("pwd");
+        bench_sink += shell_execute(bench_line);
+    }
+}
+
+void bench_exec_external(int n) {
+    for (int i = 0; i < n; i++) {
+        bench_set_line("true -q");
+        bench_sink += shell_execute(bench_line);
+    }
+}
+
+void bench_exec_pipeline(int n) {
+    for (int i = 0; i < n; i++) {
+        bench_sink += exec_pipeline("cat /data/notes.txt | grep bridge | wc -l");
+    }
+}
+
+void bench_exec_redirect(int n) {
+    for (int i = 0; i < n; i++) {
+        bench_set_line("cat /data/notes.txt > /data/out.txt");
+        bench_sink += shell_execute(bench_line);
+    }
+}
+
+static void bench_session_main(void) {
+    shell_main();
+}
+
+// Feed a scripted session through the line editor and dispatcher.
+// Returns the number of command lines executed per run.
+static const char *bench_session_script =
+    "pwd\n"
+    "ls /data\n"
+    "cd /data\n"
+    "echo hello from the hosted bench\n"
+    "true -q\n"
+    "cat notes.txt | grep bridge | wc -l\n"
+    "cd /\n"
+    "ls\n";
+#define BENCH_SESSION_LINES 8
+
+void bench_session(int n) {
+    for (int i = 0; i < n; i++) {
+        heap_reset();
+        hosted_kbd_feed_text(bench_session_script);
+        hosted_kbd_run(bench_session_main);
+    }
+    heap_reset();
+}
+
+int bench_session_lines(void) {
+    return BENCH_SESSION_LINES;
+}
+
+// The same session as a script file, run through the batch entry point
+// (bridge /data/session.sh: no line editor)
+void bench_script(int n) {
+    hosted_fs_write("/data/session.sh", bench_session_script, str_len(bench_session_script));
+    char *argv[] = { "bridge", "/data/session.sh", 0 };
+    for (int i = 0; i < n; i++) {
+        heap_reset();
+        shell_run(2, argv);
+    }
+    heap_reset();
+}
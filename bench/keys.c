@@ -0,0 +1,255 @@
+// Line-editor keystroke replay benchmark.
+//
+//   bridge-keys [-v] [scenario-filter | file.keys]
+//
+// Replays recorded key sequences into shell_read_line() through the stub
+// keyboard and measures, per keystroke, the host time until the editor
+// asks for the next key plus the console operations it issued. Reports
+// p50/p99 per scenario.
+//
+// Recording format: plain characters are typed as-is; {L n}, {R n} and
+// {B n} press Left, Right and Backspace n times; {T n} types n filler
+// characters (a paste when used as one burst). Enter is appended.
+
+#include "../shell.c"
+#include "hosted.h"
+#include "console.h"
+
+extern int sprintf(char *buf, const char *fmt, ...);
+extern int strlen(const char *s);
+extern int strcmp(const char *a, const char *b);
+
+#define KEYS_MAX_EVENTS 1024
+#define KEYS_MAX_SAMPLES (1 << 18)
+#define KEYS_RUNS 200
+
+struct keys_scenario {
+    const char *name;
+    const char *recording;
+};
+
+static const struct keys_scenario keys_scenarios[] = {
+    { "type-short",   "echo hello world" },
+    { "type-long",    "{T 400}" },
+    { "edit-middle",  "{T 60}{L 30}inserted{B 5}{R 10}xyz" },
+    { "cursor-moves", "{T 80}{L 80}{R 80}" },
+    { "backspace",    "{T 120}{B 120}" },
+    { "paste-append", "{T 200}{T 250}" },
+    { "long-insert",  "{T 300}{L 290}{T 100}" },
+};
+
+struct keys_sample {
+    uint64_t ns;
+    uint32_t putc;
+    uint32_t set_cursor;
+};
+
+static struct key_event keys_events[KEYS_MAX_EVENTS];
+static struct keys_sample keys_samples[KEYS_MAX_SAMPLES];
+static int keys_sample_count = 0;
+
+// Console/time state at the moment the previous key was delivered
+static uint64_t keys_prev_ns;
+static uint64_t keys_prev_putc;
+static uint64_t keys_prev_cursor;
+static int keys_have_prev = 0;
+
+static void keys_close_sample(uint64_t now) {
+    if (!keys_have_prev || keys_sample_count >= KEYS_MAX_SAMPLES) return;
+    struct keys_sample *s = &keys_samples[keys_sample_count++];
+    s->ns = now - keys_prev_ns;
+    s->putc = (uint32_t)(hosted_console.putc - keys_prev_putc);
+    s->set_cursor = (uint32_t)(hosted_console.set_cursor - keys_prev_cursor);
+}
+
+static void keys_hook(const struct key_event *ev) {
+    (void)ev;
+    uint64_t now = hosted_now_ns();
+    keys_close_sample(now);
+    keys_prev_putc = hosted_console.putc;
+    keys_prev_cursor = hosted_console.set_cursor;
+    keys_have_prev = 1;
+    // Exclude the hook's own bookkeeping from the next sample
+    keys_prev_ns = hosted_now_ns();
+}
+
+static int keys_parse_count(const char **p) {
+    int n = 0;
+    while (**p == ' ') (*p)++;
+    while (**p >= '0' && **p <= '9') n = n * 10 + (*(*p)++ - '0');
+    return n;
+}
+
+// Expand a recording into key events; returns the event count
+static int keys_compile(const char *rec) {
+    int count = 0;
+    int filler = 0;
+    const char *p = rec;
+    while (*p && count < KEYS_MAX_EVENTS - 1) {
+        struct key_event ev;
+        ev.modifiers = 0;
+        ev.pressed = 1;
+        if (*p == '{') {
+            char op = p[1];
+            p += 2;
+            int n = keys_parse_count(&p);
+            while (*p && *p != '}') p++;
+            if (*p) p++;
+            for (int i = 0; i < n && count < KEYS_MAX_EVENTS - 1; i++) {
+                if (op == 'L') ev.key = KEY_LEFT;
+                else if (op == 'R') ev.key = KEY_RIGHT;
+                else if (op == 'B') ev.key = '\b';
+                else ev.key = "abcdefghij klmnopqrst $VAR | grep "[filler++ % 35];
+                keys_events[count++] = ev;
+            }
+        } else if (*p == '\n') {
+            p++;
+        } else {
+            ev.key = (uint8_t)*p++;
+            keys_events[count++] = ev;
+        }
+    }
+    keys_events[count].key = '\n';
+    keys_events[count].modifiers = 0;
+    keys_events[count].pressed = 1;
+    return count + 1;
+}
+
+static void keys_read_line(void) {
+    shell_read_line();
+    keys_close_sample(hosted_now_ns());
+    keys_have_prev = 0;
+}
+
+static void keys_sort(uint64_t *v, int n) {
+    // Heapsort: samples can be large and nearly sorted
+    for (int start = n / 2 - 1; start >= 0; start--) {
+        for (int root = start;;) {
+            int child = root * 2 + 1;
+            if (child >= n) break;
+            if (child + 1 < n && v[child + 1] > v[child]) child++;
+            if (v[root] >= v[child]) break;
+            uint64_t t = v[root]; v[root] = v[child]; v[child] = t;
+            root = child;
+        }
+    }
+    for (int end = n - 1; end > 0; end--) {
+        uint64_t t = v[0]; v[0] = v[end]; v[end] = t;
+        for (int root = 0;;) {
+            int child = root * 2 + 1;
+            if (child >= end) break;
+            if (child + 1 < end && v[child + 1] > v[child]) child++;
+            if (v[root] >= v[child]) break;
+            t = v[root]; v[root] = v[child]; v[child] = t;
+            root = child;
+        }
+    }
+}
+
+static uint64_t keys_scratch[KEYS_MAX_SAMPLES];
+
+static uint64_t keys_percentile(int count, int pct) {
+    int idx = (int)((uint64_t)(count - 1) * pct / 100);
+    return keys_scratch[idx];
+}
+
+static void print_col(const char *s, int width) {
+    int len = strlen(s);
+    for (int i = len; i < width; i++) hosted_write(1, " ", 1);
+    hosted_write(1, s, len);
+}
+
+static void print_ratio(uint64_t total, int count, int width) {
+    char buf[32];
+    uint64_t tenths = count ? total * 10 / count : 0;
+    sprintf(buf, "%d.%d", (int)(tenths / 10), (int)(tenths % 10));
+    print_col(buf, width);
+}
+
+static void keys_run(const char *name, const char *recording) {
+    int events = keys_compile(recording);
+    keys_sample_count = 0;
+
+    for (int run = 0; run < KEYS_RUNS; run++) {
+        hosted_console_reset();
+        console_set_cursor(0, 2);   // after a "$ " prompt
+        hosted_kbd_feed(keys_events, events);
+        hosted_kbd_run(keys_read_line);
+    }
+
+    int n = keys_sample_count;
+    uint64_t putc_total = 0, cursor_total = 0;
+    uint32_t putc_max = 0;
+    for (int i = 0; i < n; i++) {
+        keys_scratch[i] = keys_samples[i].ns;
+        putc_total += keys_samples[i].putc;
+        cursor_total += keys_samples[i].set_cursor;
+        if (keys_samples[i].putc > putc_max) putc_max = keys_samples[i].putc;
+    }
+    keys_sort(keys_scratch, n);
+
+    char buf[32];
+    hosted_puts(name);
+    for (int i = strlen(name); i < 16; i++) hosted_write(1, " ", 1);
+    sprintf(buf, "%d", events);
+    print_col(buf, 6);
+    sprintf(buf, "%d", (int)keys_percentile(n, 50));
+    print_col(buf, 10);
+    sprintf(buf, "%d", (int)keys_percentile(n, 99));
+    print_col(buf, 10);
+    sprintf(buf, "%d", (int)keys_scratch[n - 1]);
+    print_col(buf, 10);
+    print_ratio(putc_total, n, 10);
+    sprintf(buf, "%d", (int)putc_max);
+    print_col(buf, 9);
+    print_ratio(cursor_total, n, 10);
+    hosted_puts("\n");
+}
+
+static int keys_matches(const char *name, const char *filter) {
+    int n = strlen(filter);
+    for (int i = 0; name[i]; i++) {
+        int j = 0;
+        while (j < n && name[i + j] == filter[j]) j++;
+        if (j == n) return 1;
+    }
+    return n == 0;
+}
+
+// A recording is named *.keys; anything else is a scenario filter
+static int keys_is_file(const char *arg) {
+    const char *suffix = ".keys";
+    int n = strlen(arg);
+    int len = strlen(suffix);
+    return n > len && strcmp(arg + n - len, suffix) == 0;
+}
+
+static char keys_file_buf[8192];
+
+int hosted_main(int argc, char **argv) {
+    int arg = 1;
+    if (arg < argc && argv[arg][0] == '-' && argv[arg][1] == 'v') {
+        hosted_console_echo(1);
+        arg++;
+    }
+    const char *filter = arg < argc ? argv[arg] : "";
+
+    hosted_fs_reset();
+    hosted_sched_reset();
+    hosted_kbd_hook = keys_hook;
+
+    hosted_puts("scenario          keys   p50(ns)   p99(ns)   max(ns)  putc/key putc-max  cur/key\n");
+    if (keys_is_file(filter)) {
+        if (hosted_read_file(filter, keys_file_buf, sizeof(keys_file_buf)) < 0) {
+            hosted_puts("bridge-keys: cannot read recording\n");
+            return 1;
+        }
+        keys_run(filter, keys_file_buf);
+        return 0;
+    }
+    for (unsigned i = 0; i < sizeof(keys_scenarios) / sizeof(keys_scenarios[0]); i++) {
+        if (!keys_matches(keys_scenarios[i].name, filter)) continue;
+        keys_run(keys_scenarios[i].name, keys_scenarios[i].recording);
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+// Heavy variable expansion: many variables, specials, braces and home paths
+set user = "root";
+set project = "bridge";
+set build = "hosted";
+set target = "x86_64-elf";
+set mode = "release";
+set count = 0;
+
+for word in "alpha beta gamma delta epsilon zeta eta theta iota kappa lambda mu" {
+    echo $word $user $project ${build} $target $mode;
+    echo ~ $project $HOME $PWD $?;
+    set count = $count + 1;
+}
+
+set k = 0;
+while $k < 60 {
+    echo $user $project $build $target $mode $count $k;
+    echo "quoted\twith\tescapes" 'single quoted' $HOME;
+    set last = $k;
+    set k = $k + 1;
+}
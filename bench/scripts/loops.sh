@@ -0,0 +1,24 @@
+// Counting loops: evaluator dispatch and integer arithmetic
+set i = 0;
+set total = 0;
+while $i < 400 {
+    set total = $total + $i * 2 - 1;
+    set i = $i + 1;
+}
+
+set j = 0;
+while true {
+    set j = $j + 1;
+    if $j >= 150 {
+        break;
+    }
+}
+
+set outer = 0;
+while $outer < 20 {
+    set inner = 0;
+    while $inner < 20 {
+        set inner = $inner + 1;
+    }
+    set outer = $outer + 1;
+}
@@ -0,0 +1,33 @@
+// Nested if/elif/else chains inside a loop
+set n = 0;
+set small = 0;
+set medium = 0;
+set large = 0;
+while $n < 120 {
+    if $n < 10 {
+        set small = $small + 1;
+    } elif $n < 40 {
+        if $n == 20 {
+            set medium = $medium + 10;
+        } elif $n == 30 {
+            set medium = $medium + 20;
+        } else {
+            set medium = $medium + 1;
+        }
+    } elif $n < 80 {
+        if ($n / 2) * 2 == $n {
+            set large = $large + 2;
+        } else {
+            if $n > 70 && $n != 75 {
+                set large = $large + 3;
+            } else {
+                set large = $large + 1;
+            }
+        }
+    } else {
+        if !($n == 100) || $n >= 110 {
+            set large = $large - 1;
+        }
+    }
+    set n = $n + 1;
+}
@@ -0,0 +1,21 @@
+// Long pipelines and and/or chains, mostly built from builtins
+pwd | echo one | echo two | echo three | echo four | echo five;
+echo alpha beta | echo gamma | echo delta | echo epsilon;
+pwd && echo ok || echo failed;
+pwd && echo a && echo b && echo c || echo never;
+
+set p = 0;
+while $p < 40 {
+    pwd | echo stage one | echo stage two | echo stage three;
+    echo left && echo right || echo other;
+    set p = $p + 1;
+}
+
+// Builtins and programs in one pipeline: the builtin's output feeds the
+// program, and a program writing into a builtin is not left blocked
+echo bridge into a program | grep bridge;
+pwd | echo middle | wc;
+wc < /bench/scripts/loops.sh | echo after a program;
+
+cd "/" && pwd | echo root;
+cd ~ || echo nohome;
@@ -0,0 +1,60 @@
+// Hosted build support: helpers shared by the stub kernel, the libc-free
+// runtime and the benchmark runners. Not used by the kernel build.
+
+#ifndef HOSTED_H
+#define HOSTED_H
+
+#include <stdint.h>
+#include "drivers/keyboard.h"
+#include "fs/vfs.h"
+
+// ---------------------------------------------------------------------------
+// Runtime (runtime.c) - raw Linux syscalls, no libc
+// ---------------------------------------------------------------------------
+
+void hosted_write(int fd, const char *s, int len);
+void hosted_puts(const char *s);
+void hosted_exit(int code);
+uint64_t hosted_now_ns(void);
+// Read a host file into buf (NUL-terminated). Returns length or -1.
+int hosted_read_file(const char *path, char *buf, int size);
+
+// ---------------------------------------------------------------------------
+// Stub kernel (kernel_stub.c)
+// ---------------------------------------------------------------------------
+
+struct hosted_console_stats {
+    uint64_t putc;
+    uint64_t set_cursor;
+    uint64_t get_cursor;
+    uint64_t clear;
+};
+
+extern struct hosted_console_stats hosted_console;
+
+// Forward console output to stdout (off by default)
+void hosted_console_echo(int on);
+void hosted_console_reset(void);
+
+// Scripted keyboard. When the queue runs dry, control returns to the most
+// recent hosted_kbd_run() caller instead of blocking.
+void hosted_kbd_feed(const struct key_event *events, int count);
+void hosted_kbd_feed_text(const char *text);
+int hosted_kbd_pending(void);
+// Invoked by keyboard_poll_event/keyboard_get_event for every delivered event
+extern void (*hosted_kbd_hook)(const struct key_event *ev);
+// Runs fn() until it returns or keyboard input is exhausted
+void hosted_kbd_run(void (*fn)(void));
+
+// In-memory filesystem
+void hosted_fs_reset(void);
+struct vfs_node *hosted_fs_mkdir(const char *path);
+struct vfs_node *hosted_fs_write(const char *path, const char *data, int len);
+
+// Scheduler
+void hosted_sched_reset(void);
+
+// Keep system_ticks (PIT rate, ~18.2 Hz) in step with the host clock
+void hosted_ticks_update(void);
+
+#endif
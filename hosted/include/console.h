@@ -0,0 +1,12 @@
+// Hosted stand-in for the kernel console. Output is counted and, when
+// echo is enabled, forwarded to the host's stdout.
+
+#ifndef HOSTED_CONSOLE_H
+#define HOSTED_CONSOLE_H
+
+void console_putc(int c);
+void console_clear(void);
+void console_get_cursor(int *row, int *col);
+void console_set_cursor(int row, int col);
+
+#endif
@@ -0,0 +1,30 @@
+// Hosted stand-in for the kernel keyboard driver interface.
+// Only the subset BRIDGE uses; events come from a scripted queue.
+
+#ifndef HOSTED_KEYBOARD_H
+#define HOSTED_KEYBOARD_H
+
+#include <stdint.h>
+
+#define MOD_SHIFT 0x01
+#define MOD_CTRL  0x02
+#define MOD_ALT   0x04
+
+#define KEY_UP    0x80
+#define KEY_DOWN  0x81
+#define KEY_LEFT  0x82
+#define KEY_RIGHT 0x83
+#define KEY_HOME  0x84
+#define KEY_END   0x85
+#define KEY_DELETE 0x86
+
+struct key_event {
+    uint16_t key;
+    uint8_t modifiers;
+    uint8_t pressed;
+};
+
+struct key_event keyboard_get_event(void);
+int keyboard_poll_event(struct key_event *ev);
+
+#endif
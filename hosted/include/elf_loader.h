@@ -0,0 +1,7 @@
+// Hosted stand-in: BRIDGE includes the ELF loader header but calls
+// nothing from it directly.
+
+#ifndef HOSTED_ELF_LOADER_H
+#define HOSTED_ELF_LOADER_H
+
+#endif
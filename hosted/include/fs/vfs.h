@@ -0,0 +1,37 @@
+// Hosted stand-in for the kernel VFS interface (in-memory tree).
+
+#ifndef HOSTED_VFS_H
+#define HOSTED_VFS_H
+
+#include <stdint.h>
+
+#define VFS_MAX_PATH 256
+#define VFS_MAX_NAME 64
+
+#define VFS_FILE      0x01
+#define VFS_DIRECTORY 0x02
+
+struct vfs_node {
+    char name[VFS_MAX_NAME];
+    uint32_t flags;
+    uint32_t size;
+    uint32_t mtime;
+    // Hosted-only storage
+    uint32_t capacity;
+    uint8_t *data;
+    struct vfs_node *parent;
+    struct vfs_node *first_child;
+    struct vfs_node *next_sibling;
+};
+
+struct dirent {
+    char name[VFS_MAX_NAME];
+    uint32_t inode;
+};
+
+struct vfs_node *vfs_resolve_path(const char *path);
+struct dirent *vfs_readdir(struct vfs_node *node, uint32_t index);
+int vfs_read(struct vfs_node *node, uint32_t offset, uint32_t size, uint8_t *buffer);
+int vfs_write(struct vfs_node *node, uint32_t offset, uint32_t size, const uint8_t *buffer);
+
+#endif
@@ -0,0 +1,51 @@
+// Hosted stand-in for the kernel scheduler, task and FD table interface.
+
+#ifndef HOSTED_SCHED_H
+#define HOSTED_SCHED_H
+
+#include <stdint.h>
+
+#define MAX_FDS 64
+
+#define FD_UNUSED  0
+#define FD_FILE    1
+#define FD_DIR     2
+#define FD_CONSOLE 3
+#define FD_PIPE    4
+
+#define PIPE_BUF_SIZE 512
+
+enum task_state {
+    TASK_READY,
+    TASK_RUNNING,
+    TASK_BLOCKED,
+    TASK_ZOMBIE,
+};
+
+struct pipe {
+    char buffer[PIPE_BUF_SIZE];
+    int read_pos, write_pos, count;
+    int read_open, write_open;
+};
+
+struct fd_entry {
+    int type;
+    void *node;
+    unsigned int offset;
+    int flags;
+    struct pipe *pipe;
+};
+
+struct task {
+    uint64_t id;
+    int pgid;
+    enum task_state state;
+    uint64_t runtime_ticks;
+    int exit_code;
+    int used;
+};
+
+int sched_spawn(const char *path, char **args, struct fd_entry *fd_overrides);
+int sched_waitpid(int pid);
+
+#endif
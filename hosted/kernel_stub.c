@@ -0,0 +1,430 @@
+// In-memory stand-in for the PHOBOS kernel services BRIDGE links against:
+// VFS/FAT32, keyboard, console, scheduler, pipes and the PIT tick counter.
+// Behaviour is deliberately simple; the point is to exercise BRIDGE's own
+// code paths on a development machine.
+
+#include "hosted.h"
+#include "sched.h"
+#include "console.h"
+
+extern void *memcpy(void *dst, const void *src, int n);
+extern void *memset(void *s, int c, int n);
+extern int strcmp(const char *a, const char *b);
+extern int strlen(const char *s);
+
+#define HOSTED_MAX_NODES  4096
+#define HOSTED_DATA_SIZE  (4 * 1024 * 1024)
+#define HOSTED_MAX_TASKS  64
+#define HOSTED_MAX_PIPES  64
+#define HOSTED_KBD_QUEUE  8192
+
+// PIT runs at ~18.2 Hz: one tick every 54925 us
+#define HOSTED_NS_PER_TICK 54925000ull
+
+volatile uint64_t system_ticks = 0;
+static uint64_t ticks_epoch_ns = 0;
+
+void hosted_ticks_update(void) {
+    uint64_t now = hosted_now_ns();
+    if (ticks_epoch_ns == 0) ticks_epoch_ns = now;
+    system_ticks = (now - ticks_epoch_ns) / HOSTED_NS_PER_TICK;
+}
+
+// ============================================================================
+// Console
+// ============================================================================
+
+#define CONSOLE_COLS 80
+#define CONSOLE_ROWS 25
+
+struct hosted_console_stats hosted_console;
+static int console_row = 0;
+static int console_col = 0;
+static int console_echo = 0;
+
+void hosted_console_echo(int on) {
+    console_echo = on;
+}
+
+void hosted_console_reset(void) {
+    memset(&hosted_console, 0, sizeof(hosted_console));
+    console_row = 0;
+    console_col = 0;
+}
+
+void console_putc(int c) {
+    hosted_console.putc++;
+    if (console_echo) {
+        char ch = (char)c;
+        hosted_write(1, &ch, 1);
+    }
+    if (c == '\n') {
+        console_col = 0;
+        if (console_row < CONSOLE_ROWS - 1) console_row++;
+    } else if (c == '\b') {
+        if (console_col > 0) console_col--;
+    } else if (++console_col >= CONSOLE_COLS) {
+        console_col = 0;
+        if (console_row < CONSOLE_ROWS - 1) console_row++;
+    }
+}
+
+void console_clear(void) {
+    hosted_console.clear++;
+    console_row = 0;
+    console_col = 0;
+}
+
+void console_get_cursor(int *row, int *col) {
+    hosted_console.get_cursor++;
+    *row = console_row;
+    *col = console_col;
+}
+
+void console_set_cursor(int row, int col) {
+    hosted_console.set_cursor++;
+    console_row = row;
+    console_col = col;
+}
+
+// ============================================================================
+// Keyboard
+// ============================================================================
+
+static struct key_event kbd_queue[HOSTED_KBD_QUEUE];
+static int kbd_head = 0;
+static int kbd_tail = 0;
+static void *kbd_jmp[5];
+static int kbd_jmp_armed = 0;
+
+void (*hosted_kbd_hook)(const struct key_event *ev) = 0;
+
+void hosted_kbd_feed(const struct key_event *events, int count) {
+    if (kbd_head == kbd_tail) kbd_head = kbd_tail = 0;
+    for (int i = 0; i < count && kbd_tail < HOSTED_KBD_QUEUE; i++) {
+        kbd_queue[kbd_tail++] = events[i];
+    }
+}
+
+void hosted_kbd_feed_text(const char *text) {
+    struct key_event ev;
+    ev.modifiers = 0;
+    ev.pressed = 1;
+    for (int i = 0; text[i]; i++) {
+        ev.key = (uint8_t)text[i];
+        hosted_kbd_feed(&ev, 1);
+    }
+}
+
+int hosted_kbd_pending(void) {
+    return kbd_tail - kbd_head;
+}
+
+static void kbd_exhausted(void) {
+    kbd_head = kbd_tail = 0;
+    if (kbd_jmp_armed) {
+        kbd_jmp_armed = 0;
+        __builtin_longjmp(kbd_jmp, 1);
+    }
+    hosted_puts("hosted: keyboard input exhausted\n");
+    hosted_exit(1);
+}
+
+void hosted_kbd_run(void (*fn)(void)) {
+    if (__builtin_setjmp(kbd_jmp) == 0) {
+        kbd_jmp_armed = 1;
+        fn();
+    }
+    kbd_jmp_armed = 0;
+}
+
+int keyboard_poll_event(struct key_event *ev) {
+    hosted_ticks_update();
+    if (kbd_head == kbd_tail) kbd_exhausted();
+    *ev = kbd_queue[kbd_head++];
+    if (hosted_kbd_hook) hosted_kbd_hook(ev);
+    return 1;
+}
+
+struct key_event keyboard_get_event(void) {
+    struct key_event ev;
+    keyboard_poll_event(&ev);
+    return ev;
+}
+
+// ============================================================================
+// Filesystem (in-memory tree standing in for VFS + FAT32)
+// ============================================================================
+
+static struct vfs_node nodes[HOSTED_MAX_NODES];
+static int node_count = 0;
+static uint8_t data_arena[HOSTED_DATA_SIZE];
+static int data_used = 0;
+static struct dirent readdir_entry;
+static uint32_t fs_clock = 0;
+
+// vfs_readdir() is index based; remember the last position so sequential
+// enumeration is O(1) per entry like a FAT32 cluster walk.
+static struct vfs_node *readdir_dir = 0;
+static struct vfs_node *readdir_pos = 0;
+static uint32_t readdir_index = 0;
+
+static struct vfs_node *fs_root(void) {
+    if (node_count == 0) {
+        memset(&nodes[0], 0, sizeof(nodes[0]));
+        nodes[0].name[0] = '/';
+        nodes[0].flags = VFS_DIRECTORY;
+        node_count = 1;
+    }
+    return &nodes[0];
+}
+
+void hosted_fs_reset(void) {
+    node_count = 0;
+    data_used = 0;
+    readdir_dir = 0;
+    fs_root();
+}
+
+static struct vfs_node *fs_child(struct vfs_node *dir, const char *name, int len) {
+    for (struct vfs_node *c = dir->first_child; c; c = c->next_sibling) {
+        int i = 0;
+        while (i < len && c->name[i] == name[i]) i++;
+        if (i == len && c->name[len] == '\0') return c;
+    }
+    return 0;
+}
+
+static struct vfs_node *fs_add(struct vfs_node *dir, const char *name, int len, uint32_t flags) {
+    if (node_count >= HOSTED_MAX_NODES || len >= VFS_MAX_NAME) return 0;
+    struct vfs_node *n = &nodes[node_count++];
+    memset(n, 0, sizeof(*n));
+    memcpy(n->name, name, len);
+    n->name[len] = '\0';
+    n->flags = flags;
+    n->mtime = ++fs_clock;
+    n->parent = dir;
+    // Append so readdir order matches creation order
+    struct vfs_node **link = &dir->first_child;
+    while (*link) link = &(*link)->next_sibling;
+    *link = n;
+    readdir_dir = 0;
+    return n;
+}
+
+// Walk path; with create_dirs, missing directories are created along the way.
+// When leaf_file is set the final component is created as a file instead.
+static struct vfs_node *fs_walk(const char *path, int create_dirs, int leaf_file) {
+    struct vfs_node *cur = fs_root();
+    const char *p = path;
+    while (*p) {
+        while (*p == '/') p++;
+        if (!*p) break;
+        const char *start = p;
+        while (*p && *p != '/') p++;
+        int len = (int)(p - start);
+        while (*p == '/') p++;
+        int last = (*p == '\0');
+
+        if (len == 1 && start[0] == '.') continue;
+        if (len == 2 && start[0] == '.' && start[1] == '.') {
+            if (cur->parent) cur = cur->parent;
+            continue;
+        }
+        struct vfs_node *next = fs_child(cur, start, len);
+        if (!next) {
+            if (!create_dirs) return 0;
+            next = fs_add(cur, start, len, (last && leaf_file) ? VFS_FILE : VFS_DIRECTORY);
+            if (!next) return 0;
+        }
+        cur = next;
+    }
+    return cur;
+}
+
+static int fs_reserve(struct vfs_node *node, uint32_t size) {
+    if (size <= node->capacity) return 0;
+    uint32_t cap = node->capacity ? node->capacity : 64;
+    while (cap < size) cap *= 2;
+    if (data_used + (int)cap > HOSTED_DATA_SIZE) return -1;
+    uint8_t *data = &data_arena[data_used];
+    data_used += cap;
+    if (node->size) memcpy(data, node->data, node->size);
+    node->data = data;
+    node->capacity = cap;
+    return 0;
+}
+
+struct vfs_node *vfs_resolve_path(const char *path) {
+    if (!path) return 0;
+    return fs_walk(path, 0, 0);
+}
+
+struct dirent *vfs_readdir(struct vfs_node *node, uint32_t index) {
+    if (!node || !(node->flags & VFS_DIRECTORY)) return 0;
+    struct vfs_node *c;
+    uint32_t i;
+    if (readdir_dir == node && readdir_pos && index >= readdir_index) {
+        c = readdir_pos;
+        i = readdir_index;
+    } else {
+        c = node->first_child;
+        i = 0;
+    }
+    while (c && i < index) {
+        c = c->next_sibling;
+        i++;
+    }
+    if (!c) return 0;
+    readdir_dir = node;
+    readdir_pos = c;
+    readdir_index = i;
+
+    int len = strlen(c->name);
+    memcpy(readdir_entry.name, c->name, len + 1);
+    readdir_entry.inode = (uint32_t)(c - nodes);
+    return &readdir_entry;
+}
+
+int vfs_read(struct vfs_node *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
+    if (!node || !(node->flags & VFS_FILE)) return -1;
+    if (offset >= node->size) return 0;
+    if (size > node->size - offset) size = node->size - offset;
+    memcpy(buffer, node->data + offset, size);
+    return (int)size;
+}
+
+int vfs_write(struct vfs_node *node, uint32_t offset, uint32_t size, const uint8_t *buffer) {
+    if (!node || !(node->flags & VFS_FILE)) return -1;
+    if (fs_reserve(node, offset + size) != 0) return -1;
+    if (offset > node->size) memset(node->data + node->size, 0, offset - node->size);
+    memcpy(node->data + offset, buffer, size);
+    if (offset + size > node->size) node->size = offset + size;
+    node->mtime = ++fs_clock;
+    return (int)size;
+}
+
+struct vfs_node *ensure_path_exists(const char *path) {
+    return fs_walk(path, 1, 0);
+}
+
+int fat32_touch_path(const char *path) {
+    struct vfs_node *n = vfs_resolve_path(path);
+    if (n) return 0;
+    // Parent must already exist, as on FAT32
+    int len = strlen(path);
+    int slash = len - 1;
+    while (slash > 0 && path[slash] != '/') slash--;
+    char parent[VFS_MAX_PATH];
+    if (slash >= VFS_MAX_PATH) return -1;
+    memcpy(parent, path, slash);
+    parent[slash] = '\0';
+    struct vfs_node *dir = slash ? vfs_resolve_path(parent) : fs_root();
+    if (!dir || !(dir->flags & VFS_DIRECTORY)) return -1;
+    return fs_add(dir, path + slash + 1, len - slash - 1, VFS_FILE) ? 0 : -1;
+}
+
+int fat32_truncate(struct vfs_node *node, int size) {
+    if (!node || !(node->flags & VFS_FILE) || size < 0) return -1;
+    if ((uint32_t)size < node->size) node->size = size;
+    return 0;
+}
+
+int fat32_flush_size(struct vfs_node *node) {
+    return node ? 0 : -1;
+}
+
+struct vfs_node *hosted_fs_mkdir(const char *path) {
+    return ensure_path_exists(path);
+}
+
+struct vfs_node *hosted_fs_write(const char *path, const char *data, int len) {
+    struct vfs_node *n = fs_walk(path, 1, 1);
+    if (!n) return 0;
+    n->size = 0;
+    if (len > 0 && vfs_write(n, 0, len, (const uint8_t *)data) != len) return 0;
+    return n;
+}
+
+// ============================================================================
+// Scheduler, TTY and pipes
+// ============================================================================
+
+// Programs are not executed; a spawn creates a task that exits with 0 as
+// soon as it is waited on. This keeps pipeline/redirect setup measurable.
+
+static struct task tasks[HOSTED_MAX_TASKS];
+static int next_pid = 2;
+static int foreground_pgid = 1;
+static struct pipe pipes[HOSTED_MAX_PIPES];
+static int next_pipe = 0;
+
+void hosted_sched_reset(void) {
+    memset(tasks, 0, sizeof(tasks));
+    tasks[1].id = 1;
+    tasks[1].pgid = 1;
+    tasks[1].state = TASK_RUNNING;
+    tasks[1].used = 1;
+    next_pid = 2;
+    foreground_pgid = 1;
+}
+
+struct task *sched_get_task(int pid) {
+    if (pid <= 0 || pid >= HOSTED_MAX_TASKS || !tasks[pid].used) return 0;
+    return &tasks[pid];
+}
+
+struct task *sched_current(void) {
+    if (!tasks[1].used) hosted_sched_reset();
+    return &tasks[1];
+}
+
+int sched_spawn(const char *path, char **args, struct fd_entry *fd_overrides) {
+    (void)args;
+    (void)fd_overrides;
+    struct vfs_node *n = vfs_resolve_path(path);
+    if (!n || !(n->flags & VFS_FILE)) return -1;
+
+    // Recycle slots of reaped tasks
+    for (int tries = 0; tries < HOSTED_MAX_TASKS; tries++) {
+        int pid = next_pid;
+        next_pid = (next_pid + 1 < HOSTED_MAX_TASKS) ? next_pid + 1 : 2;
+        if (!tasks[pid].used) {
+            memset(&tasks[pid], 0, sizeof(tasks[pid]));
+            tasks[pid].id = pid;
+            tasks[pid].pgid = pid;
+            // Nothing is executed: the task has already exited with 0
+            // and stays a zombie until sched_waitpid() reaps it
+            tasks[pid].state = TASK_ZOMBIE;
+            tasks[pid].used = 1;
+            return pid;
+        }
+    }
+    return -1;
+}
+
+int sched_waitpid(int pid) {
+    struct task *t = sched_get_task(pid);
+    if (!t) return -1;
+    int code = t->exit_code;
+    t->used = 0;
+    return code;
+}
+
+void tty_set_foreground_pgid(int pgid) {
+    foreground_pgid = pgid;
+}
+
+void *pipe_alloc(void) {
+    struct pipe *p = &pipes[next_pipe];
+    next_pipe = (next_pipe + 1) % HOSTED_MAX_PIPES;
+    memset(p, 0, sizeof(*p));
+    p->read_open = 1;
+    p->write_open = 1;
+    return p;
+}
+
+int task_fd_alloc(void *t) {
+    (void)t;
+    return -1;
+}
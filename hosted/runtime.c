@@ -0,0 +1,80 @@
+// Minimal libc-free runtime for the hosted build.
+// lib.c provides malloc/strlen/printf itself, so the hosted binaries are
+// linked with -nostdlib and talk to Linux through raw syscalls.
+
+#include "hosted.h"
+
+#define SYS_READ           0
+#define SYS_WRITE          1
+#define SYS_OPEN           2
+#define SYS_CLOSE          3
+#define SYS_EXIT_GROUP     231
+#define SYS_CLOCK_GETTIME  228
+#define CLOCK_MONOTONIC    1
+
+extern int strlen(const char *s);
+extern int hosted_main(int argc, char **argv);
+
+static long hosted_syscall3(long n, long a, long b, long c) {
+    long ret;
+    __asm__ volatile ("syscall"
+                      : "=a"(ret)
+                      : "a"(n), "D"(a), "S"(b), "d"(c)
+                      : "rcx", "r11", "memory");
+    return ret;
+}
+
+void hosted_write(int fd, const char *s, int len) {
+    while (len > 0) {
+        long n = hosted_syscall3(SYS_WRITE, fd, (long)s, len);
+        if (n <= 0) return;
+        s += n;
+        len -= (int)n;
+    }
+}
+
+int hosted_read_file(const char *path, char *buf, int size) {
+    long fd = hosted_syscall3(SYS_OPEN, (long)path, 0, 0);
+    if (fd < 0) return -1;
+    int len = 0;
+    while (len < size - 1) {
+        long n = hosted_syscall3(SYS_READ, fd, (long)(buf + len), size - 1 - len);
+        if (n <= 0) break;
+        len += (int)n;
+    }
+    hosted_syscall3(SYS_CLOSE, fd, 0, 0);
+    buf[len] = '\0';
+    return len;
+}
+
+void hosted_puts(const char *s) {
+    hosted_write(1, s, strlen(s));
+}
+
+void hosted_exit(int code) {
+    hosted_syscall3(SYS_EXIT_GROUP, code, 0, 0);
+    for (;;) { }
+}
+
+uint64_t hosted_now_ns(void) {
+    struct { long sec; long nsec; } ts;
+    hosted_syscall3(SYS_CLOCK_GETTIME, CLOCK_MONOTONIC, (long)&ts, 0);
+    return (uint64_t)ts.sec * 1000000000ull + (uint64_t)ts.nsec;
+}
+
+void hosted_start(long *sp) {
+    int argc = (int)sp[0];
+    char **argv = (char **)(sp + 1);
+    hosted_exit(hosted_main(argc, argv));
+}
+
+__asm__(
+    ".text\n"
+    ".global _start\n"
+    "_start:\n"
+    "    xor %rbp, %rbp\n"
+    "    mov %rsp, %rdi\n"
+    "    and $-16, %rsp\n"
+    "    call hosted_start\n"
+    "    hlt\n"
+);
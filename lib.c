@@ -11,6 +11,12 @@
 extern struct task *sched_current(void);
 extern struct task *sched_get_task(int pid);
 extern void tty_set_foreground_pgid(int pgid);
+extern volatile uint64_t system_ticks;
+extern void *pipe_alloc(void);
+extern int fat32_touch_path(const char *path);
+extern int fat32_truncate(struct vfs_node *node, int size);
+extern int fat32_flush_size(struct vfs_node *node);
+extern struct vfs_node *ensure_path_exists(const char *path);
 
 int getpid(void) {
     struct task *t = sched_current();
@@ -33,34 +39,238 @@ int tcsetpgrp(int pgid) {
     return 0;
 }
 
+// ============================================================================
+// Task Inspection (read-only view of the scheduler task table for ps/top)
+// ============================================================================
+
+// Highest pid probed when walking the task table
+#ifndef BRIDGE_MAX_PID
+#define BRIDGE_MAX_PID 64
+#endif
+
+int task_max_pid(void) {
+    return BRIDGE_MAX_PID;
+}
+
+// Fill in pgid, state and accumulated runtime ticks for pid.
+// Returns 0 if the task exists, -1 otherwise. Does not allocate.
+int task_query(int pid, int *pgid, int *state, uint64_t *ticks) {
+    struct task *t = sched_get_task(pid);
+    if (!t) return -1;
+    if (pgid) *pgid = t->pgid;
+    if (state) *state = (int)t->state;
+    if (ticks) *ticks = t->runtime_ticks;
+    return 0;
+}
+
+const char *task_state_name(int state) {
+    switch (state) {
+        case TASK_RUNNING: return "run";
+        case TASK_READY:   return "ready";
+        case TASK_BLOCKED: return "block";
+        case TASK_ZOMBIE:  return "zombie";
+        default:           return "?";
+    }
+}
+
 // ============================================================================
 // Memory Allocator (bump allocator with static buffer)
 // ============================================================================
 
 #define HEAP_SIZE 65536  // 64KB heap for shell
 
+// Size classes for the allocation histogram: 8, 16, 32, ... 2048, >= 4096
+#define HEAP_SIZE_CLASSES 10
+// Distinct call-site tags tracked at once (extra tags fold into the last slot)
+#define HEAP_MAX_TAGS 8
+
 static char heap[HEAP_SIZE];
 static int heap_offset = 0;
 
-// Forward declaration
+struct heap_tag_stats {
+    const char* tag;
+    int bytes;
+    int count;
+};
+
+struct heap_stats {
+    int high_water;
+    int alloc_count;
+    int alloc_bytes;
+    int failed_count;
+    int histogram[HEAP_SIZE_CLASSES];
+    struct heap_tag_stats tags[HEAP_MAX_TAGS];
+    int tag_count;
+};
+
+static struct heap_stats heap_stats;
+static struct heap_stats heap_snap;
+static int heap_snap_offset = 0;
+static const char* heap_tag = (const char*)0;
+
+// Forward declarations
 void mt_print(const char* s);
+void print_int(int n);
+int strcmp(const char* a, const char* b);
+void* memset(void* s, int c, int n);
+
+static int heap_size_class(int aligned_size) {
+    int cls = 0;
+    int limit = 8;
+    while (limit < aligned_size && cls < HEAP_SIZE_CLASSES - 1) {
+        limit <<= 1;
+        cls++;
+    }
+    return cls;
+}
 
-char* malloc(int size) {
+static struct heap_tag_stats* heap_tag_slot(const char* tag) {
+    for (int i = 0; i < heap_stats.tag_count; i++) {
+        const char* t = heap_stats.tags[i].tag;
+        if (t == tag || (t && tag && strcmp(t, tag) == 0)) {
+            return &heap_stats.tags[i];
+        }
+    }
+    if (heap_stats.tag_count < HEAP_MAX_TAGS) {
+        struct heap_tag_stats* slot = &heap_stats.tags[heap_stats.tag_count++];
+        slot->tag = tag;
+        slot->bytes = 0;
+        slot->count = 0;
+        return slot;
+    }
+    return &heap_stats.tags[HEAP_MAX_TAGS - 1];
+}
+
+// Attribute subsequent allocations to a call site or phase (e.g. "tokenize").
+// Returns the previous tag so callers can restore it. NULL means untagged.
+const char* heap_set_tag(const char* tag) {
+    const char* prev = heap_tag;
+    heap_tag = tag;
+    return prev;
+}
+
+static void heap_report_exhausted(int size);
+
+// report: print [HEAP EXHAUSTED] on failure. Callers that degrade on
+// their own (string builders) fail quietly, and are only counted.
+static char* heap_alloc(int size, int report) {
     int aligned_size = (size + 7) & ~7;
     if (heap_offset + aligned_size > HEAP_SIZE) {
-        mt_print("\n[HEAP EXHAUSTED]\n");
+        heap_stats.failed_count++;
+        if (report) heap_report_exhausted(size);
         return (char*)0;
     }
     char* ptr = &heap[heap_offset];
     heap_offset += aligned_size;
+
+    heap_stats.alloc_count++;
+    heap_stats.alloc_bytes += aligned_size;
+    heap_stats.histogram[heap_size_class(aligned_size)]++;
+    if (heap_offset > heap_stats.high_water) {
+        heap_stats.high_water = heap_offset;
+    }
+    struct heap_tag_stats* slot = heap_tag_slot(heap_tag);
+    slot->bytes += aligned_size;
+    slot->count++;
     return ptr;
 }
 
+char* malloc(int size) {
+    return heap_alloc(size, 1);
+}
+
 // Reset heap for new command (call between commands)
 void heap_reset(void) {
     heap_offset = 0;
 }
 
+int heap_used(void) {
+    return heap_offset;
+}
+
+// Scoped reclamation: everything allocated after heap_mark() is discarded
+// by heap_release(mark). Callers must not keep pointers into that range.
+int heap_mark(void) {
+    return heap_offset;
+}
+
+void heap_release(int mark) {
+    if (mark >= 0 && mark <= heap_offset) {
+        heap_offset = mark;
+    }
+}
+
+// Clear counters and histogram; the high-water mark restarts at current usage.
+void heap_stats_reset(void) {
+    memset(&heap_stats, 0, sizeof(heap_stats));
+    heap_stats.high_water = heap_offset;
+}
+
+static void heap_print_row(const char* label, int value) {
+    mt_print("  ");
+    mt_print(label);
+    print_int(value);
+    mt_print("\n");
+}
+
+static void heap_print_class(int cls) {
+    mt_print(cls == HEAP_SIZE_CLASSES - 1 ? "  >=" : "  <=");
+    print_int(8 << cls);
+}
+
+void heap_print_stats(void) {
+    mt_print("heap:\n");
+    heap_print_row("size:        ", HEAP_SIZE);
+    heap_print_row("in use:      ", heap_offset);
+    heap_print_row("high water:  ", heap_stats.high_water);
+    heap_print_row("allocations: ", heap_stats.alloc_count);
+    heap_print_row("bytes:       ", heap_stats.alloc_bytes);
+    heap_print_row("failed:      ", heap_stats.failed_count);
+    mt_print("size classes:\n");
+    for (int i = 0; i < HEAP_SIZE_CLASSES; i++) {
+        if (heap_stats.histogram[i] == 0) continue;
+        heap_print_class(i);
+        mt_print(": ");
+        print_int(heap_stats.histogram[i]);
+        mt_print("\n");
+    }
+    if (heap_stats.tag_count > 0) {
+        mt_print("tags:\n");
+        for (int i = 0; i < heap_stats.tag_count; i++) {
+            mt_print("  ");
+            mt_print(heap_stats.tags[i].tag ? heap_stats.tags[i].tag : "-");
+            mt_print(": ");
+            print_int(heap_stats.tags[i].bytes);
+            mt_print(" bytes in ");
+            print_int(heap_stats.tags[i].count);
+            mt_print(" allocs\n");
+        }
+    }
+}
+
+// Snapshot counters before a command; heap_print_diff() reports the delta.
+void heap_snapshot(void) {
+    heap_snap = heap_stats;
+    heap_snap_offset = heap_offset;
+}
+
+void heap_print_diff(void) {
+    mt_print("heap delta:\n");
+    heap_print_row("in use:      ", heap_offset - heap_snap_offset);
+    heap_print_row("allocations: ", heap_stats.alloc_count - heap_snap.alloc_count);
+    heap_print_row("bytes:       ", heap_stats.alloc_bytes - heap_snap.alloc_bytes);
+    heap_print_row("failed:      ", heap_stats.failed_count - heap_snap.failed_count);
+    heap_print_row("high water:  ", heap_stats.high_water - heap_snap.high_water);
+    for (int i = 0; i < HEAP_SIZE_CLASSES; i++) {
+        int delta = heap_stats.histogram[i] - heap_snap.histogram[i];
+        if (delta == 0) continue;
+        heap_print_class(i);
+        mt_print(": +");
+        print_int(delta);
+        mt_print("\n");
+    }
+}
+
 void free(void* ptr) {
     // Bump allocator doesn't free - would need a real allocator
     (void)ptr;
@@ -79,6 +289,25 @@ char* realloc(void* ptr, int new_size) {
     return new_ptr;
 }
 
+// Grow the most recent allocation in place (bump allocators can only do
+// this for the block at the top). Returns 1 on success, 0 if ptr is not the
+// last block or the heap is too small - the caller then copies instead.
+static int heap_grow_last(char* ptr, int old_size, int new_size) {
+    int start = (int)(ptr - heap);
+    int old_aligned = (old_size + 7) & ~7;
+    int new_aligned = (new_size + 7) & ~7;
+    if (start + old_aligned != heap_offset) return 0;
+    if (start + new_aligned > HEAP_SIZE) return 0;
+
+    heap_offset = start + new_aligned;
+    heap_stats.alloc_bytes += new_aligned - old_aligned;
+    if (heap_offset > heap_stats.high_water) {
+        heap_stats.high_water = heap_offset;
+    }
+    heap_tag_slot(heap_tag)->bytes += new_aligned - old_aligned;
+    return 1;
+}
+
 void* memcpy(void* dst, const void* src, int n) {
     char* d = (char*)dst;
     const char* s = (const char*)src;
@@ -173,18 +402,481 @@ char* concat_strings(const char* a, const char* b) {
     return result;
 }
 
+// ----------------------------------------------------------------------------
+// Span helpers: let mt-lang code address text as (offset, length) in a source
+// buffer and only copy when a string is really needed.
+// ----------------------------------------------------------------------------
+
+// Byte at index i as an unsigned code (0 past the terminator)
+int char_at(const char* s, int i) {
+    return (unsigned char)s[i];
+}
+
+char* substr(const char* s, int start, int len) {
+    char* out = malloc(len + 1);
+    if (!out) return (char*)0;
+    memcpy(out, s + start, len);
+    out[len] = '\0';
+    return out;
+}
+
+// Compare s[start..start+len) with a NUL-terminated literal, no allocation
+int span_eq(const char* s, int start, int len, const char* lit) {
+    const char* p = s + start;
+    for (int i = 0; i < len; i++) {
+        if (lit[i] == '\0' || p[i] != lit[i]) return 0;
+    }
+    return lit[len] == '\0';
+}
+
+// Materialize a quoted string body, processing backslash escapes in one pass
+char* unescape_span(const char* s, int start, int len) {
+    char* out = malloc(len + 1);
+    if (!out) return (char*)0;
+    const char* p = s + start;
+    int o = 0;
+    for (int i = 0; i < len; i++) {
+        if (p[i] != '\\' || i + 1 >= len) {
+            out[o++] = p[i];
+            continue;
+        }
+        char e = p[++i];
+        switch (e) {
+            case 'n':  out[o++] = '\n'; break;
+            case 't':  out[o++] = '\t'; break;
+            case 'r':  out[o++] = '\r'; break;
+            case '\\': out[o++] = '\\'; break;
+            case '"':  out[o++] = '"'; break;
+            case '\'': out[o++] = '\''; break;
+            case '0':  out[o++] = '\0'; break;
+            default:
+                out[o++] = '\\';
+                out[o++] = e;
+                break;
+        }
+    }
+    out[o] = '\0';
+    return out;
+}
+
+// ----------------------------------------------------------------------------
+// Character classification: one 256-entry table, O(1) per query. mt-lang
+// code passes codes from char_at() instead of single-character strings.
+// ----------------------------------------------------------------------------
+
+#define CT_DIGIT  0x01
+#define CT_UPPER  0x02
+#define CT_LOWER  0x04
+#define CT_SPACE  0x08
+#define CT_UNDER  0x10  // '_' (word character)
+#define CT_SYMBOL 0x20  // single-character shell operator
+#define CT_QUOTE  0x40
+
+#define CT_ALPHA (CT_UPPER | CT_LOWER)
+#define CT_ALNUM (CT_ALPHA | CT_DIGIT)
+#define CT_WORD  (CT_ALNUM | CT_UNDER)
+
+static const unsigned char ctype_table[256] = {
+    ['0' ... '9'] = CT_DIGIT,
+    ['A' ... 'Z'] = CT_UPPER,
+    ['a' ... 'z'] = CT_LOWER,
+    [' '] = CT_SPACE, ['\t'] = CT_SPACE, ['\n'] = CT_SPACE, ['\r'] = CT_SPACE,
+    ['_'] = CT_UNDER,
+    ['"'] = CT_QUOTE, ['\''] = CT_QUOTE,
+    ['('] = CT_SYMBOL, [')'] = CT_SYMBOL, ['['] = CT_SYMBOL, [']'] = CT_SYMBOL,
+    ['{'] = CT_SYMBOL, ['}'] = CT_SYMBOL, [','] = CT_SYMBOL, ['.'] = CT_SYMBOL,
+    [':'] = CT_SYMBOL, ['!'] = CT_SYMBOL, ['+'] = CT_SYMBOL, ['-'] = CT_SYMBOL,
+    ['*'] = CT_SYMBOL, ['/'] = CT_SYMBOL, ['='] = CT_SYMBOL, ['>'] = CT_SYMBOL,
+    ['<'] = CT_SYMBOL, ['|'] = CT_SYMBOL, ['&'] = CT_SYMBOL, [';'] = CT_SYMBOL,
+};
+
+int char_class(int c)   { return ctype_table[c & 0xFF]; }
+int char_isdigit(int c) { return (ctype_table[c & 0xFF] & CT_DIGIT) != 0; }
+int char_isalpha(int c) { return (ctype_table[c & 0xFF] & CT_ALPHA) != 0; }
+int char_isalnum(int c) { return (ctype_table[c & 0xFF] & CT_ALNUM) != 0; }
+int char_isword(int c)  { return (ctype_table[c & 0xFF] & CT_WORD) != 0; }
+int char_isspace(int c) { return (ctype_table[c & 0xFF] & CT_SPACE) != 0; }
+
 int tolower(int c) {
-    if (c >= 'A' && c <= 'Z') {
-        return c + ('a' - 'A');
+    return (ctype_table[c & 0xFF] & CT_UPPER) ? c + ('a' - 'A') : c;
+}
+
+int toupper(int c) {
+    return (ctype_table[c & 0xFF] & CT_LOWER) ? c - ('a' - 'A') : c;
+}
+
+// Case-map a whole string into one allocation
+char* str_lower(const char* s) {
+    int len = strlen(s);
+    char* out = malloc(len + 1);
+    if (!out) return (char*)0;
+    for (int i = 0; i < len; i++) out[i] = (char)tolower((unsigned char)s[i]);
+    out[len] = '\0';
+    return out;
+}
+
+char* str_upper(const char* s) {
+    int len = strlen(s);
+    char* out = malloc(len + 1);
+    if (!out) return (char*)0;
+    for (int i = 0; i < len; i++) out[i] = (char)toupper((unsigned char)s[i]);
+    out[len] = '\0';
+    return out;
+}
+
+// ----------------------------------------------------------------------------
+// String builder: appends are amortised O(1) (capacity doubles, and grows in
+// place while the buffer is the newest heap block), so building a string
+// piece by piece stays linear. The text is always NUL-terminated;
+// sb_finish() hands it out without copying. mt-lang holds a builder as an
+// opaque string handle (see StringBuilder in mtclib/strings.mtc).
+// ----------------------------------------------------------------------------
+
+struct strbuf {
+    char* data;
+    int len;
+    int cap;    // bytes available for text, excluding the terminator
+};
+
+struct strbuf* sb_new(int capacity) {
+    if (capacity < 16) capacity = 16;
+    struct strbuf* sb = (struct strbuf*)malloc(sizeof(struct strbuf));
+    if (!sb) return (struct strbuf*)0;
+    sb->data = malloc(capacity + 1);
+    sb->len = 0;
+    sb->cap = sb->data ? capacity : 0;
+    if (sb->data) sb->data[0] = '\0';
+    return sb;
+}
+
+// Make room for extra more bytes; 0 if the heap is exhausted
+static int sb_reserve(struct strbuf* sb, int extra) {
+    int need = sb->len + extra;
+    if (need <= sb->cap) return 1;
+
+    int cap = sb->cap ? sb->cap : 16;
+    while (cap < need) cap *= 2;
+
+    if (sb->data && heap_grow_last(sb->data, sb->cap + 1, cap + 1)) {
+        sb->cap = cap;
+        return 1;
+    }
+    // A builder that cannot grow keeps what it has (a capture ends up
+    // truncated); reporting here would print into the builder again
+    char* data = heap_alloc(cap + 1, 0);
+    if (!data) return 0;
+    if (sb->data) memcpy(data, sb->data, sb->len + 1);
+    sb->data = data;
+    sb->cap = cap;
+    return 1;
+}
+
+void sb_append_span(struct strbuf* sb, const char* s, int start, int len) {
+    if (len <= 0 || !sb_reserve(sb, len)) return;
+    memcpy(sb->data + sb->len, s + start, len);
+    sb->len += len;
+    sb->data[sb->len] = '\0';
+}
+
+void sb_append(struct strbuf* sb, const char* s) {
+    sb_append_span(sb, s, 0, strlen(s));
+}
+
+void sb_append_char(struct strbuf* sb, int c) {
+    if (!sb_reserve(sb, 1)) return;
+    sb->data[sb->len++] = (char)c;
+    sb->data[sb->len] = '\0';
+}
+
+void sb_append_int(struct strbuf* sb, int n) {
+    char digits[12];
+    int count = 0;
+    unsigned int u = n < 0 ? 0u - (unsigned int)n : (unsigned int)n;
+    do {
+        digits[count++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (n < 0) sb_append_char(sb, '-');
+    if (!sb_reserve(sb, count)) return;
+    while (count > 0) sb->data[sb->len++] = digits[--count];
+    sb->data[sb->len] = '\0';
+}
+
+// Little-endian 32-bit word, for binary records (see sb_write_file)
+void sb_append_u32(struct strbuf* sb, int v) {
+    if (!sb_reserve(sb, 4)) return;
+    unsigned int u = (unsigned int)v;
+    for (int i = 0; i < 4; i++) {
+        sb->data[sb->len++] = (char)(u & 0xFF);
+        u >>= 8;
+    }
+    sb->data[sb->len] = '\0';
+}
+
+int sb_length(struct strbuf* sb) {
+    return sb->len;
+}
+
+void sb_clear(struct strbuf* sb) {
+    sb->len = 0;
+    if (sb->data) sb->data[0] = '\0';
+}
+
+// The built text. Later appends may move or overwrite it; copy first if the
+// builder is reused.
+char* sb_finish(struct strbuf* sb) {
+    return sb->data ? sb->data : "";
+}
+
+// ----------------------------------------------------------------------------
+// Lexer lookup tables: keyword perfect hash and operator dispatch by first
+// byte. IDs must match the KW_* / OP_* constants in tokenizer.mtc.
+// ----------------------------------------------------------------------------
+
+enum {
+    KW_WHILE = 1, KW_BREAK, KW_IF, KW_ELIF, KW_ELSE,
+    KW_FOR, KW_SET, KW_TRUE, KW_FALSE, KW_IN,
+};
+
+enum {
+    OP_LPAREN = 1, OP_RPAREN, OP_LBRACKET, OP_RBRACKET, OP_LBRACE, OP_RBRACE,
+    OP_COMMA, OP_DOT, OP_COLON, OP_NOT, OP_PLUS, OP_MINUS, OP_STAR, OP_SLASH,
+    OP_ASSIGN, OP_GT, OP_LT, OP_PIPE, OP_AMP, OP_SEMI,
+    // Two-character operators start here
+    OP_EQ = 32, OP_NE, OP_PLUS_EQ, OP_GE, OP_LE, OP_AND, OP_OR, OP_APPEND, OP_HEREDOC,
+    OP_COUNT
+};
+
+// Perfect hash over the keyword set: (len + 3 * first + last) & 15 is
+// collision-free for these ten words (found by exhaustive search over small
+// multipliers). Re-run the search when adding a keyword.
+#define KW_HASH(len, first, last) (((len) + 3 * (first) + (last)) & 15)
+
+static const struct { const char* word; int id; } keyword_table[16] = {
+    [KW_HASH(5, 'w', 'e')] = { "while", KW_WHILE },
+    [KW_HASH(5, 'b', 'k')] = { "break", KW_BREAK },
+    [KW_HASH(2, 'i', 'f')] = { "if",    KW_IF },
+    [KW_HASH(4, 'e', 'f')] = { "elif",  KW_ELIF },
+    [KW_HASH(4, 'e', 'e')] = { "else",  KW_ELSE },
+    [KW_HASH(3, 'f', 'r')] = { "for",   KW_FOR },
+    [KW_HASH(3, 's', 't')] = { "set",   KW_SET },
+    [KW_HASH(4, 't', 'e')] = { "true",  KW_TRUE },
+    [KW_HASH(5, 'f', 'e')] = { "false", KW_FALSE },
+    [KW_HASH(2, 'i', 'n')] = { "in",    KW_IN },
+};
+
+// Keyword id of s[start..start+len), or 0 if it is not a keyword
+int keyword_id(const char* s, int start, int len) {
+    if (len < 2 || len > 5) return 0;
+    const char* p = s + start;
+    int h = KW_HASH(len, (unsigned char)p[0], (unsigned char)p[len - 1]);
+    const char* word = keyword_table[h].word;
+    if (!word || !span_eq(s, start, len, word)) return 0;
+    return keyword_table[h].id;
+}
+
+// Single-character operator for each first byte
+static const unsigned char op_single[256] = {
+    ['('] = OP_LPAREN, [')'] = OP_RPAREN, ['['] = OP_LBRACKET, [']'] = OP_RBRACKET,
+    ['{'] = OP_LBRACE, ['}'] = OP_RBRACE, [','] = OP_COMMA, ['.'] = OP_DOT,
+    [':'] = OP_COLON, ['!'] = OP_NOT, ['+'] = OP_PLUS, ['-'] = OP_MINUS,
+    ['*'] = OP_STAR, ['/'] = OP_SLASH, ['='] = OP_ASSIGN, ['>'] = OP_GT,
+    ['<'] = OP_LT, ['|'] = OP_PIPE, ['&'] = OP_AMP, [';'] = OP_SEMI,
+};
+
+// Two-character continuations for each first byte (at most two each)
+static const struct { char second; unsigned char op; } op_double[256][2] = {
+    ['='] = { { '=', OP_EQ } },
+    ['!'] = { { '=', OP_NE } },
+    ['+'] = { { '=', OP_PLUS_EQ } },
+    ['>'] = { { '=', OP_GE }, { '>', OP_APPEND } },
+    ['<'] = { { '=', OP_LE }, { '<', OP_HEREDOC } },
+    ['&'] = { { '&', OP_AND } },
+    ['|'] = { { '|', OP_OR } },
+};
+
+static const char* const op_names[OP_COUNT] = {
+    [OP_LPAREN] = "(", [OP_RPAREN] = ")", [OP_LBRACKET] = "[", [OP_RBRACKET] = "]",
+    [OP_LBRACE] = "{", [OP_RBRACE] = "}", [OP_COMMA] = ",", [OP_DOT] = ".",
+    [OP_COLON] = ":", [OP_NOT] = "!", [OP_PLUS] = "+", [OP_MINUS] = "-",
+    [OP_STAR] = "*", [OP_SLASH] = "/", [OP_ASSIGN] = "=", [OP_GT] = ">",
+    [OP_LT] = "<", [OP_PIPE] = "|", [OP_AMP] = "&", [OP_SEMI] = ";",
+    [OP_EQ] = "==", [OP_NE] = "!=", [OP_PLUS_EQ] = "+=", [OP_GE] = ">=",
+    [OP_LE] = "<=", [OP_AND] = "&&", [OP_OR] = "||", [OP_APPEND] = ">>",
+    [OP_HEREDOC] = "<<",
+};
+
+// Operator starting at s[pos] (longest match), or 0. s must be NUL-terminated.
+int symbol_at(const char* s, int pos) {
+    unsigned char c = (unsigned char)s[pos];
+    char next = s[pos + 1];
+    if (next) {
+        for (int i = 0; i < 2; i++) {
+            if (op_double[c][i].op && op_double[c][i].second == next) {
+                return op_double[c][i].op;
+            }
+        }
     }
-    return c;
+    return op_single[c];
+}
+
+int op_length(int op) {
+    return op >= OP_EQ ? 2 : 1;
+}
+
+const char* op_name(int op) {
+    if (op <= 0 || op >= OP_COUNT || !op_names[op]) return "?";
+    return op_names[op];
+}
+
+// ----------------------------------------------------------------------------
+// Name interning: each distinct variable name maps to a small dense id, so
+// the mt-lang environment hashes ints instead of comparing strings. Names
+// are copied into a static pool, so ids survive heap_reset(). Ids 1..3 are
+// reserved for the special variables and must match VAR_* in evaluator.mtc.
+// ----------------------------------------------------------------------------
+
+#define INTERN_CAP 1024             // power of two; at most INTERN_CAP/2 names
+#define INTERN_POOL_SIZE 16384
+
+enum { VAR_STATUS = 1, VAR_HOME, VAR_PWD };
+
+static char intern_pool[INTERN_POOL_SIZE];
+static int intern_pool_used = 0;
+static const char* intern_names[INTERN_CAP / 2 + 1];   // by id
+static uint32_t intern_hashes[INTERN_CAP / 2 + 1];
+static uint16_t intern_table[INTERN_CAP];              // hash slot -> id, 0 = empty
+static int intern_count = 0;
+
+// FNV-1a over s[0..len)
+static uint32_t str_hash_span(const char* s, int len) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t str_hash(const char* s) {
+    return str_hash_span(s, strlen(s));
+}
+
+static int intern_add(const char* s, int len) {
+    uint32_t h = str_hash_span(s, len);
+    uint32_t slot = h & (INTERN_CAP - 1);
+    while (intern_table[slot]) {
+        int id = intern_table[slot];
+        if (intern_hashes[id] == h && span_eq(s, 0, len, intern_names[id])) {
+            return id;
+        }
+        slot = (slot + 1) & (INTERN_CAP - 1);
+    }
+
+    if (intern_count >= INTERN_CAP / 2 || intern_pool_used + len + 1 > INTERN_POOL_SIZE) {
+        mt_print("intern: name table full (");
+        print_int(intern_count);
+        mt_print(" names)\n");
+        return 0;
+    }
+
+    char* copy = intern_pool + intern_pool_used;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    intern_pool_used += len + 1;
+
+    int id = ++intern_count;
+    intern_names[id] = copy;
+    intern_hashes[id] = h;
+    intern_table[slot] = (uint16_t)id;
+    return id;
+}
+
+static int intern_span(const char* s, int len) {
+    if (intern_count == 0) {
+        // Reserve the special variables' ids before any other name
+        intern_add("?", 1);
+        intern_add("HOME", 4);
+        intern_add("PWD", 3);
+    }
+    return intern_add(s, len);
+}
+
+// Id of name (>= 1), adding it on first use; 0 if the table is full
+int intern(const char* name) {
+    return intern_span(name, strlen(name));
+}
+
+const char* intern_name(int id) {
+    if (id <= 0 || id > intern_count) return "";
+    return intern_names[id];
+}
+
+int intern_count_names(void) {
+    return intern_count;
+}
+
+// Console output buffering for batch runs (bridge script.sh, source).
+// While enabled, print_char() collects output here and it reaches the
+// console in runs: when the buffer fills, before anything else can write
+// to the screen (a spawned program, cursor moves, clear, line input) and
+// when buffering is switched off.
+#define CONSOLE_BUF_SIZE 1024
+
+static char console_buf[CONSOLE_BUF_SIZE];
+static int console_buf_len = 0;
+static int console_buffered = 0;
+
+// Set while capture_begin() is collecting output for $(...)
+static struct strbuf* capture_sb = (struct strbuf*)0;
+
+// Straight to the console even while output is captured: the report may
+// come from growing the capture buffer itself
+static void heap_report_exhausted(int size) {
+    struct strbuf* captured = capture_sb;
+    capture_sb = (struct strbuf*)0;
+    mt_print("\n[HEAP EXHAUSTED] request=");
+    print_int(size);
+    mt_print(" in_use=");
+    print_int(heap_offset);
+    mt_print("/");
+    print_int(HEAP_SIZE);
+    mt_print(" tag=");
+    mt_print(heap_tag ? heap_tag : "-");
+    mt_print("\n");
+    capture_sb = captured;
+}
+
+void console_flush(void) {
+    for (int i = 0; i < console_buf_len; i++) {
+        console_putc(console_buf[i]);
+    }
+    console_buf_len = 0;
+}
+
+// Returns the previous setting so callers can nest
+int console_buffering(int on) {
+    int was = console_buffered;
+    if (!on) console_flush();
+    console_buffered = on;
+    return was;
 }
 
 void cursor_get(int *row, int *col) {
+    console_flush();
     console_get_cursor(row, col);
 }
 
 void print_char(int c) {
+    if (capture_sb) {
+        sb_append_char(capture_sb, c);
+        return;
+    }
+    if (console_buffered) {
+        if (console_buf_len == CONSOLE_BUF_SIZE) console_flush();
+        console_buf[console_buf_len++] = (char)c;
+        return;
+    }
     console_putc(c);
 }
 
@@ -332,11 +1024,18 @@ void exit(int code) {
     }
 }
 
+// PIT ticks since boot (~18.2 per second)
+int uptime_ticks(void) {
+    return (int)system_ticks;
+}
+
 void clear_screen(void) {
+    console_flush();
     console_clear();
 }
 
 void set_cursor(int row, int col) {
+    console_flush();
     console_set_cursor(row, col);
 }
 
@@ -348,6 +1047,7 @@ static char line_buffer[512];
 static int line_pos = 0;
 
 char* read_line(void) {
+    console_flush();
     line_pos = 0;
 
     while (1) {
@@ -443,10 +1143,9 @@ static int normalize_path(const char *in, char *out, int out_size) {
     return 0;
 }
 
-int set_cwd(const char* path) {
-    // Handle relative paths
+// Resolve path against the cwd and normalize it into out (VFS_MAX_PATH)
+static int absolute_path(const char* path, char* out) {
     char full_path[VFS_MAX_PATH];
-    char normalized[VFS_MAX_PATH];
 
     if (path[0] == '/') {
         strncpy(full_path, path, VFS_MAX_PATH - 1);
@@ -463,7 +1162,15 @@ int set_cwd(const char* path) {
         strncat(full_path, path, remaining);
     }
 
-    if (normalize_path(full_path, normalized, VFS_MAX_PATH) != 0) {
+    return normalize_path(full_path, out, VFS_MAX_PATH);
+}
+
+int env_set(const char* name, const char* value);
+
+int set_cwd(const char* path) {
+    char normalized[VFS_MAX_PATH];
+
+    if (absolute_path(path, normalized) != 0) {
         return -1;
     }
 
@@ -478,6 +1185,7 @@ int set_cwd(const char* path) {
 
     strncpy(cwd, normalized, VFS_MAX_PATH - 1);
     cwd[VFS_MAX_PATH - 1] = '\0';
+    env_set("PWD", cwd);
     return 0;
 }
 
@@ -504,14 +1212,6 @@ char* read_file(const char* path) {
     return buffer;
 }
 
-int write_file(const char* path, const char* content) {
-    struct vfs_node* node = vfs_resolve_path(path);
-    if (!node) return -1;
-
-    int len = strlen(content);
-    return vfs_write(node, 0, len, (const uint8_t*)content);
-}
-
 // List directory - returns array of names
 // For mt-lang, we'll build a simple linked structure
 typedef struct dir_entry_list {
@@ -588,13 +1288,186 @@ char* list_dir(const char* path) {
     return result;
 }
 
+// ============================================================================
+// Exported environment, handed to every spawned program
+// ============================================================================
+//
+// Exported variables live packed in env_block as NAME=value\0NAME=value\0\0,
+// edited in place by env_set()/env_unset(). The kernel's spawn call only
+// takes an argv, so env_argv() puts an envp-style tail after its NULL:
+// ENV_ARGV_MARK and one pointer per variable.
+//
+//   { args..., 0, ENV_ARGV_MARK, "HOME=/users/root", "PWD=/", ..., 0 }
+//
+// argc and the arguments are unchanged. The pointer tail is only rebuilt
+// after the block changes, so spawning in a loop copies just the argument
+// pointers. Programs read their variables with env_lookup(argv, name).
+
+#define ENV_BLOCK_SIZE 2048
+#define ENV_MAX_VARS 64
+#define ENV_MAX_ARGS 64
+#define ENV_ARGV_SLOTS (ENV_MAX_ARGS + 2 + ENV_MAX_VARS + 1)
+
+const char ENV_ARGV_MARK[] = "\x1e" "env";
+
+static char env_block[ENV_BLOCK_SIZE];
+static int env_used = 0;                // bytes of entries, before the final \0
+static int env_count = 0;
+static int env_ready = 0;
+static int env_dirty = 1;               // env_spawn_argv's tail is stale
+static char* env_spawn_argv[ENV_ARGV_SLOTS];
+static int env_tail = ENV_ARGV_SLOTS;   // index of argv's NULL in it
+
+// Offset of the NAME=... entry in env_block, or -1
+static int env_find(const char* name, int len) {
+    int pos = 0;
+    while (pos < env_used) {
+        if (span_eq(env_block, pos, len, name) && env_block[pos + len] == '=') return pos;
+        pos += strlen(env_block + pos) + 1;
+    }
+    return -1;
+}
+
+static void env_remove(int pos) {
+    int entry = strlen(env_block + pos) + 1;
+    memcpy(env_block + pos, env_block + pos + entry, env_used - pos - entry + 1);
+    env_used -= entry;
+    env_count--;
+}
+
+static int env_put(const char* name, const char* value) {
+    int name_len = strlen(name);
+    if (name_len == 0) return -1;
+    int value_len = strlen(value);
+    int need = name_len + 1 + value_len + 1;
+    int pos = env_find(name, name_len);
+    int old = 0;
+    if (pos >= 0) {
+        // Unchanged values keep the cached argv tail
+        if (strcmp(env_block + pos + name_len + 1, value) == 0) return 0;
+        old = strlen(env_block + pos) + 1;
+    }
+    if (env_used - old + need + 1 > ENV_BLOCK_SIZE || (pos < 0 && env_count == ENV_MAX_VARS)) {
+        return -1;
+    }
+    if (pos >= 0) env_remove(pos);
+
+    char* entry = env_block + env_used;
+    memcpy(entry, name, name_len);
+    entry[name_len] = '=';
+    memcpy(entry + name_len + 1, value, value_len + 1);
+    env_used += need;
+    env_block[env_used] = '\0';
+    env_count++;
+    env_dirty = 1;
+    return 0;
+}
+
+static void env_init(void) {
+    if (env_ready) return;
+    env_ready = 1;
+    env_put("HOME", "/users/root");
+    env_put("PWD", cwd);
+}
+
+// Export name=value to programs started from now on; -1 if the block is full
+int env_set(const char* name, const char* value) {
+    env_init();
+    return env_put(name, value);
+}
+
+int env_unset(const char* name) {
+    env_init();
+    int pos = env_find(name, strlen(name));
+    if (pos < 0) return -1;
+    env_remove(pos);
+    env_dirty = 1;
+    return 0;
+}
+
+// Value of an exported variable, or 0
+const char* env_get(const char* name) {
+    env_init();
+    int len = strlen(name);
+    int pos = env_find(name, len);
+    return pos < 0 ? (const char*)0 : env_block + pos + len + 1;
+}
+
+// The packed block itself (NAME=value\0...\0)
+const char* env_entries(void) {
+    env_init();
+    return env_block;
+}
+
+// The entries one per line (NAME=value\n...), for export with no
+// arguments in mt-lang, which cannot walk the packed block
+char* env_listing(void) {
+    env_init();
+    struct strbuf* sb = sb_new(env_used + 1);
+    if (!sb) return "";
+    for (int pos = 0; pos < env_used; pos += strlen(env_block + pos) + 1) {
+        sb_append(sb, env_block + pos);
+        sb_append_char(sb, '\n');
+    }
+    return sb_finish(sb);
+}
+
+// argv with the environment appended, for sched_spawn(). The result is
+// shared, so it is only valid until the next call.
+char** env_argv(char** argv) {
+    env_init();
+    if (env_dirty) {
+        int slot = ENV_ARGV_SLOTS - 1;
+        env_spawn_argv[slot] = (char*)0;
+        slot -= env_count;
+        int pos = 0;
+        for (int i = slot; i < ENV_ARGV_SLOTS - 1; i++) {
+            env_spawn_argv[i] = env_block + pos;
+            pos += strlen(env_block + pos) + 1;
+        }
+        env_spawn_argv[slot - 1] = (char*)ENV_ARGV_MARK;
+        env_tail = slot - 2;
+        env_spawn_argv[env_tail] = (char*)0;
+        env_dirty = 0;
+    }
+
+    int argc = 0;
+    while (argv && argv[argc]) argc++;
+    if (argc > ENV_MAX_ARGS) {
+        mt_print("bridge: more than ");
+        print_int(ENV_MAX_ARGS);
+        mt_print(" arguments, environment not passed\n");
+        return argv;
+    }
+
+    char** out = env_spawn_argv + env_tail - argc;
+    for (int i = 0; i < argc; i++) out[i] = argv[i];
+    return out;
+}
+
+// Program side: the value of name in an argv built by env_argv(), or 0.
+// The variables follow argv's NULL.
+const char* env_lookup(char** argv, const char* name) {
+    int i = 0;
+    while (argv[i]) i++;
+    i++;
+    if (!argv[i] || strcmp(argv[i], ENV_ARGV_MARK) != 0) return (const char*)0;
+
+    int len = strlen(name);
+    for (i++; argv[i]; i++) {
+        if (span_eq(argv[i], 0, len, name) && argv[i][len] == '=') return argv[i] + len + 1;
+    }
+    return (const char*)0;
+}
+
 // ============================================================================
 // Program Execution — spawn child process and wait for it
 // ============================================================================
 
 int exec_program(const char* path, char** args) {
+    console_flush();
     int shell_pgid = getpid();
-    int pid = sched_spawn(path, args, 0);
+    int pid = sched_spawn(path, env_argv(args), 0);
     if (pid < 0) return -127;  // Special code for "not found"
 
     // Set child as foreground process group
@@ -611,5 +1484,1240 @@ int exec_program(const char* path, char** args) {
 // Spawn a program with a custom FD table (for pipe redirection).
 // Returns child PID or -1.
 int exec_program_fd(const char* path, char** args, struct fd_entry *fds) {
-    return sched_spawn(path, args, fds);
+    console_flush();
+    return sched_spawn(path, env_argv(args), fds);
+}
+
+// ============================================================================
+// File handles: open once, write with explicit lengths, flush the size once
+// ============================================================================
+//
+// file_open() resolves the path a single time; file_write() writes at the
+// handle's position (always at the end with FILE_APPEND) and
+// file_pwrite() at an explicit offset, neither moving other handles. Sizes
+// only reach the directory entry on file_flush()/file_close(), so a burst
+// of writes costs one fat32_flush_size(). Handles are small ints so
+// mt-lang can hold them.
+
+#define FILE_MAX_HANDLES 8
+
+#define FILE_CREATE   1     // create the file if it does not exist
+#define FILE_TRUNCATE 2     // drop existing contents on open
+#define FILE_APPEND   4     // every file_write() goes to the end
+
+struct file_handle {
+    struct vfs_node *node;
+    uint32_t pos;
+    int flags;
+    int dirty;              // size changed since the last flush
+    int used;
+};
+
+static struct file_handle file_handles[FILE_MAX_HANDLES];
+
+static struct file_handle *file_get(int fd) {
+    if (fd < 0 || fd >= FILE_MAX_HANDLES || !file_handles[fd].used) return (struct file_handle *)0;
+    return &file_handles[fd];
+}
+
+// Handle for path, or -1 (missing without FILE_CREATE, not a file, or no
+// free handle)
+int file_open(const char *path, int flags) {
+    int fd = 0;
+    while (fd < FILE_MAX_HANDLES && file_handles[fd].used) fd++;
+    if (fd == FILE_MAX_HANDLES) return -1;
+
+    char full[VFS_MAX_PATH];
+    if (absolute_path(path, full) != 0) return -1;
+    if (flags & FILE_CREATE) fat32_touch_path(full);
+    struct vfs_node *node = vfs_resolve_path(full);
+    if (!node || !(node->flags & VFS_FILE)) return -1;
+
+    struct file_handle *h = &file_handles[fd];
+    h->node = node;
+    h->flags = flags;
+    h->dirty = 0;
+    h->used = 1;
+    if ((flags & FILE_TRUNCATE) && node->size > 0) {
+        fat32_truncate(node, 0);
+        h->dirty = 1;
+    }
+    h->pos = (flags & FILE_APPEND) ? node->size : 0;
+    return fd;
+}
+
+// Write len bytes at offset; returns the count written or -1
+int file_pwrite(int fd, const char *data, int len, int offset) {
+    struct file_handle *h = file_get(fd);
+    if (!h || len < 0 || offset < 0) return -1;
+    if (len == 0) return 0;
+    uint32_t old_size = h->node->size;
+    int written = vfs_write(h->node, (uint32_t)offset, (uint32_t)len, (const uint8_t *)data);
+    if (h->node->size != old_size) h->dirty = 1;
+    return written;
+}
+
+// Write len bytes at the handle's position (the end when appending)
+int file_write(int fd, const char *data, int len) {
+    struct file_handle *h = file_get(fd);
+    if (!h) return -1;
+    if (h->flags & FILE_APPEND) h->pos = h->node->size;
+    int written = file_pwrite(fd, data, len, (int)h->pos);
+    if (written > 0) h->pos += written;
+    return written;
+}
+
+// file_write() of a NUL-terminated string (mt-lang text)
+int file_write_str(int fd, const char *text) {
+    return file_write(fd, text, strlen(text));
+}
+
+int file_seek(int fd, int offset) {
+    struct file_handle *h = file_get(fd);
+    if (!h || offset < 0) return -1;
+    h->pos = (uint32_t)offset;
+    return 0;
+}
+
+// Cut the file to size bytes (only shrinks)
+int file_truncate(int fd, int size) {
+    struct file_handle *h = file_get(fd);
+    if (!h || size < 0) return -1;
+    if ((uint32_t)size >= h->node->size) return 0;
+    if (fat32_truncate(h->node, size) != 0) return -1;
+    if (h->pos > (uint32_t)size) h->pos = (uint32_t)size;
+    h->dirty = 1;
+    return 0;
+}
+
+// Write the file's size to its directory entry if it changed
+int file_flush(int fd) {
+    struct file_handle *h = file_get(fd);
+    if (!h) return -1;
+    if (!h->dirty) return 0;
+    h->dirty = 0;
+    return fat32_flush_size(h->node);
+}
+
+int file_close(int fd) {
+    int status = file_flush(fd);
+    struct file_handle *h = file_get(fd);
+    if (h) h->used = 0;
+    return status;
+}
+
+// Replace path's contents with text (created if missing)
+int write_file(const char *path, const char *content) {
+    int fd = file_open(path, FILE_CREATE | FILE_TRUNCATE);
+    if (fd < 0) return -1;
+    int len = strlen(content);
+    int written = file_write(fd, content, len);
+    file_close(fd);
+    return written;
+}
+
+// Add text to the end of path (created if missing); never rewrites it
+int append_file(const char *path, const char *text) {
+    int fd = file_open(path, FILE_CREATE | FILE_APPEND);
+    if (fd < 0) return -1;
+    int len = strlen(text);
+    int written = file_write(fd, text, len);
+    file_close(fd);
+    return written;
+}
+
+// ============================================================================
+// Jobs: pipelines and redirections for the mt-lang evaluator
+// ============================================================================
+//
+// job_begin(n) sets up n stages connected by kernel pipes; stages may then
+// override stdin/stdout with files (job_redirect_in/out) and are started
+// with job_spawn(). Every stage is spawned before job_wait() waits for any
+// of them, so they run concurrently in one process group and stream
+// through the pipes, as exec_pipeline() in shell.c does. A stage that runs
+// in the shell instead (a builtin) hands its output to job_write(), and
+// every stage that is not spawned must be job_close()d so its neighbours
+// see end-of-file rather than waiting on it.
+
+#define JOB_MAX_STAGES 8
+
+struct job {
+    int stages;
+    struct pipe *pipes[JOB_MAX_STAGES - 1];
+    struct fd_entry io[JOB_MAX_STAGES][2];          // stdin, stdout per stage
+    struct vfs_node *outputs[JOB_MAX_STAGES];       // redirected files to flush
+    struct pipe *capture;                           // last stage's stdout, for $(...)
+    int pids[JOB_MAX_STAGES];
+    int pgid;
+};
+
+static struct job job;
+
+// A builtin stage (source) may run a job of its own between the outer
+// job's spawns and its job_wait(); the outer job waits here meanwhile
+#define JOB_MAX_NESTING 4
+static struct job job_saved[JOB_MAX_NESTING];
+static int job_nesting = 0;
+
+static void job_console(struct fd_entry *fd) {
+    memset(fd, 0, sizeof(*fd));
+    fd->type = FD_CONSOLE;
+}
+
+// Drop the current job, resuming the one it interrupted (if any)
+static void job_end(void) {
+    if (job_nesting > 0) job = job_saved[--job_nesting];
+    else job.stages = 0;
+}
+
+int job_begin(int stages) {
+    if (stages < 1 || stages > JOB_MAX_STAGES) {
+        mt_print("pipe: at most 8 commands in a pipeline\n");
+        return -1;
+    }
+    if (job.stages > 0) {
+        if (job_nesting == JOB_MAX_NESTING) {
+            mt_print("pipe: pipelines nested too deeply\n");
+            return -1;
+        }
+        job_saved[job_nesting++] = job;
+    }
+    memset(&job, 0, sizeof(job));
+    job.stages = stages;
+    for (int i = 0; i < stages; i++) {
+        job_console(&job.io[i][0]);
+        job_console(&job.io[i][1]);
+        job.pids[i] = -1;
+    }
+    for (int i = 0; i < stages - 1; i++) {
+        job.pipes[i] = (struct pipe *)pipe_alloc();
+        if (!job.pipes[i]) {
+            mt_print("pipe: allocation failed\n");
+            job_end();
+            return -1;
+        }
+        job.io[i][1].type = FD_PIPE;
+        job.io[i][1].pipe = job.pipes[i];
+        job.io[i][1].flags = 1;     // O_WRONLY
+        job.io[i + 1][0].type = FD_PIPE;
+        job.io[i + 1][0].pipe = job.pipes[i];
+        job.io[i + 1][0].flags = 0; // O_RDONLY
+    }
+    return 0;
+}
+
+// Open (creating) path for writing; truncate unless appending.
+// Returns the node, or 0 with an error printed.
+static struct vfs_node *job_open_output(const char *path, int append) {
+    char full[VFS_MAX_PATH];
+    if (absolute_path(path, full) != 0) return (struct vfs_node *)0;
+    fat32_touch_path(full);
+    struct vfs_node *node = vfs_resolve_path(full);
+    if (!node || !(node->flags & VFS_FILE)) {
+        mt_print("redirect: cannot open ");
+        mt_print(path);
+        mt_print("\n");
+        return (struct vfs_node *)0;
+    }
+    if (!append) fat32_truncate(node, 0);
+    return node;
+}
+
+// Point stage's stdout at path (> or, with append, >>)
+int job_redirect_out(int stage, const char *path, int append) {
+    if (stage < 0 || stage >= job.stages) return -1;
+    struct vfs_node *node = job_open_output(path, append);
+    if (!node) return -1;
+
+    // A pipe this stage would have written to now has no writer
+    if (stage < job.stages - 1) job.pipes[stage]->write_open = 0;
+    else if (job.capture) job.capture->write_open = 0;
+
+    struct fd_entry *fd = &job.io[stage][1];
+    memset(fd, 0, sizeof(*fd));
+    fd->type = FD_FILE;
+    fd->node = node;
+    fd->offset = append ? node->size : 0;
+    job.outputs[stage] = node;
+    return 0;
+}
+
+// Feed stage's stdin from path (<)
+int job_redirect_in(int stage, const char *path) {
+    if (stage < 0 || stage >= job.stages) return -1;
+    char full[VFS_MAX_PATH];
+    struct vfs_node *node = (struct vfs_node *)0;
+    if (absolute_path(path, full) == 0) node = vfs_resolve_path(full);
+    if (!node || !(node->flags & VFS_FILE)) {
+        mt_print("redirect: no such file: ");
+        mt_print(path);
+        mt_print("\n");
+        return -1;
+    }
+
+    // The pipe feeding this stage is no longer read
+    if (stage > 0) job.pipes[stage - 1]->read_open = 0;
+
+    struct fd_entry *fd = &job.io[stage][0];
+    memset(fd, 0, sizeof(*fd));
+    fd->type = FD_FILE;
+    fd->node = node;
+    return 0;
+}
+
+// Start stage; returns its pid or -1. The first stage started leads the
+// process group.
+int job_spawn(int stage, const char *path, char **args) {
+    if (stage < 0 || stage >= job.stages) return -1;
+
+    struct fd_entry fds[MAX_FDS];
+    memset(fds, 0, sizeof(fds));
+    fds[0] = job.io[stage][0];
+    fds[1] = job.io[stage][1];
+    job_console(&fds[2]);
+
+    console_flush();
+    int pid = sched_spawn(path, env_argv(args), fds);
+    if (pid < 0) return -1;
+    if (job.pgid == 0) job.pgid = pid;
+    setpgid(pid, job.pgid);
+    job.pids[stage] = pid;
+    return pid;
+}
+
+static void capture_from_task(struct pipe *p, int pid, struct strbuf *sb);
+
+// Inside capture_begin(): connect the last stage's stdout to a pipe that
+// job_wait() drains into the capture. Call before spawning the last stage.
+int job_capture_last(void) {
+    if (job.stages == 0 || !capture_sb) return -1;
+    struct pipe *p = (struct pipe *)pipe_alloc();
+    if (!p) return -1;
+    struct fd_entry *fd = &job.io[job.stages - 1][1];
+    memset(fd, 0, sizeof(*fd));
+    fd->type = FD_PIPE;
+    fd->pipe = p;
+    fd->flags = 1;      // O_WRONLY
+    job.capture = p;
+    return 0;
+}
+
+// Release the pipe ends of a stage that will not be spawned: the stage
+// before it stops blocking on a full pipe, the one after it reads EOF
+int job_close(int stage) {
+    if (stage < 0 || stage >= job.stages) return -1;
+    if (stage > 0) job.pipes[stage - 1]->read_open = 0;
+    if (stage < job.stages - 1) job.pipes[stage]->write_open = 0;
+    return 0;
+}
+
+// Write a builtin stage's output to its stdout: the pipe to the next stage
+// (waiting while it is full), or the console for the last stage. Output
+// for a stage that was not started, or has exited, is dropped. The stage's
+// write end is closed afterwards, so the reader sees EOF.
+int job_write(int stage, const char *text) {
+    if (stage < 0 || stage >= job.stages) return -1;
+    int len = strlen(text);
+    if (stage == job.stages - 1) {
+        mt_print(text);
+        return len;
+    }
+
+    struct pipe *p = job.pipes[stage];
+    int written = 0;
+    while (written < len && p->write_open && p->read_open) {
+        int size = (int)sizeof(p->buffer);
+        if (p->count == size) {
+            struct task *t = sched_get_task(job.pids[stage + 1]);
+            if (!t || t->state == TASK_ZOMBIE) break;
+            __asm__ volatile ("hlt");   // let the reader drain it
+            continue;
+        }
+        int run = size - p->count;
+        if (run > len - written) run = len - written;
+        int end = (p->read_pos + p->count) % size;
+        if (run > size - end) run = size - end;
+        memcpy(p->buffer + end, text + written, run);
+        p->write_pos = (end + run) % size;
+        p->count += run;
+        written += run;
+    }
+    p->write_open = 0;
+    return written;
+}
+
+// Wait for every spawned stage with the job in the foreground. Returns the
+// last stage's exit code, or -1 if the last stage was never spawned.
+int job_wait(void) {
+    int shell_pgid = getpid();
+    if (job.pgid > 0) tcsetpgrp(job.pgid);
+
+    // A captured last stage is read while it runs, or it would block on a
+    // full pipe and never be reaped
+    if (job.capture) {
+        capture_from_task(job.capture, job.pids[job.stages - 1], capture_sb);
+    }
+
+    int status = -1;
+    for (int i = 0; i < job.stages; i++) {
+        if (job.pids[i] <= 0) continue;
+        int code = sched_waitpid(job.pids[i]);
+        if (i == job.stages - 1) status = code;
+    }
+
+    tcsetpgrp(shell_pgid);
+    for (int i = 0; i < job.stages; i++) {
+        if (job.outputs[i]) fat32_flush_size(job.outputs[i]);
+    }
+    job_end();
+    return status;
+}
+
+// Write text to path for a redirected builtin (> or, with append, >>)
+int redirect_write(const char *path, const char *text, int append) {
+    int fd = file_open(path, FILE_CREATE | (append ? FILE_APPEND : FILE_TRUNCATE));
+    if (fd < 0) {
+        mt_print("redirect: cannot open ");
+        mt_print(path);
+        mt_print("\n");
+        return -1;
+    }
+    int len = strlen(text);
+    int written = file_write(fd, text, len);
+    file_close(fd);
+    return written == len ? 0 : -1;
+}
+
+// ============================================================================
+// Binary files: sb_write_file() stores a string builder's bytes (which may
+// include NULs); bin_open() loads a file with a single read and the bin_*
+// readers walk it. Reads past the end return 0 / "" and clear bin_ok().
+// ============================================================================
+
+struct binreader {
+    char *data;
+    int len;
+    int pos;
+    int bad;
+};
+
+int sb_write_file(struct strbuf *sb, const char *path) {
+    int fd = file_open(path, FILE_CREATE | FILE_TRUNCATE);
+    if (fd < 0) return -1;
+    int written = file_write(fd, sb->data, sb->len);
+    file_close(fd);
+    return written == sb->len ? 0 : -1;
+}
+
+// Size in bytes of a file, or -1 if it does not exist
+int file_size(const char *path) {
+    struct vfs_node *node = vfs_resolve_path(path);
+    if (!node || !(node->flags & VFS_FILE)) return -1;
+    return (int)node->size;
+}
+
+// Modification stamp of a file (0 if unknown)
+int file_mtime(const char *path) {
+    struct vfs_node *node = vfs_resolve_path(path);
+    if (!node) return 0;
+    return (int)node->mtime;
+}
+
+struct binreader *bin_open(const char *path) {
+    struct vfs_node *node = vfs_resolve_path(path);
+    if (!node || !(node->flags & VFS_FILE)) return (struct binreader *)0;
+
+    struct binreader *r = (struct binreader *)malloc(sizeof(struct binreader));
+    if (!r) return (struct binreader *)0;
+    r->data = malloc(node->size + 1);
+    if (!r->data) return (struct binreader *)0;
+    int n = vfs_read(node, 0, node->size, (uint8_t *)r->data);
+    r->len = n < 0 ? 0 : n;
+    r->pos = 0;
+    r->bad = n < 0;
+    return r;
+}
+
+int bin_u32(struct binreader *r) {
+    if (r->pos + 4 > r->len) {
+        r->bad = 1;
+        return 0;
+    }
+    const unsigned char *p = (const unsigned char *)r->data + r->pos;
+    r->pos += 4;
+    return (int)((unsigned int)p[0] | (unsigned int)p[1] << 8 |
+                 (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24);
+}
+
+// Length-prefixed string (written as sb_append_u32 + the bytes), copied
+// to the heap with a terminator
+char *bin_str(struct binreader *r) {
+    int len = bin_u32(r);
+    if (r->bad || len < 0 || r->pos + len > r->len) {
+        r->bad = 1;
+        return "";
+    }
+    char *s = malloc(len + 1);
+    if (!s) {
+        r->bad = 1;
+        return "";
+    }
+    memcpy(s, r->data + r->pos, len);
+    s[len] = '\0';
+    r->pos += len;
+    return s;
+}
+
+int bin_ok(struct binreader *r) {
+    return !r->bad;
+}
+
+int bin_at_end(struct binreader *r) {
+    return r->pos >= r->len;
+}
+
+// ============================================================================
+// Command substitution: $(...) output kept in memory
+// ============================================================================
+//
+// Builtins are captured in-process: between capture_begin() and
+// capture_end() everything printed goes to a string builder instead of the
+// console. External programs run by capture_program() write into a kernel
+// pipe that the shell drains while they run. Either way the result is a
+// heap string with trailing newlines removed; nothing touches the disk.
+
+static int capture_status = 0;
+
+static char* capture_result(struct strbuf* sb) {
+    if (!sb->data) return "";
+    while (sb->len > 0 && (sb->data[sb->len - 1] == '\n' || sb->data[sb->len - 1] == '\r')) {
+        sb->len--;
+    }
+    sb->data[sb->len] = '\0';
+    return sb->data;
+}
+
+// Returns the enclosing capture (if any); pass it back to capture_end()
+struct strbuf* capture_begin(void) {
+    struct strbuf* prev = capture_sb;
+    capture_sb = sb_new(64);
+    return prev;
+}
+
+int capture_active(void) {
+    return capture_sb != (struct strbuf*)0;
+}
+
+char* capture_end(struct strbuf* prev) {
+    struct strbuf* sb = capture_sb;
+    capture_sb = prev;
+    if (!sb) return "";
+    return capture_result(sb);
+}
+
+static void capture_drain(struct pipe *p, struct strbuf *sb) {
+    while (p->count > 0) {
+        int size = (int)sizeof(p->buffer);
+        int run = size - p->read_pos;
+        if (run > p->count) run = p->count;
+        sb_append_span(sb, p->buffer, p->read_pos, run);
+        p->read_pos = (p->read_pos + run) % size;
+        p->count -= run;
+    }
+}
+
+// Run a program with stdout on a fresh pipe and return what it wrote.
+// The pipe is emptied as the child fills it, so output is not limited to
+// one pipe buffer. capture_exit_code() gives the program's status (127 if
+// it could not be started).
+char* capture_program(const char *path, char **args) {
+    struct strbuf *sb = sb_new(128);
+    capture_status = 127;
+    if (!sb) return "";
+
+    struct pipe *p = (struct pipe *)pipe_alloc();
+    if (!p) return "";
+
+    struct fd_entry fds[MAX_FDS];
+    memset(fds, 0, sizeof(fds));
+    fds[0].type = FD_CONSOLE;
+    fds[1].type = FD_PIPE;
+    fds[1].pipe = p;
+    fds[1].flags = 1;   // write end
+    fds[2].type = FD_CONSOLE;
+
+    console_flush();
+    int pid = sched_spawn(path, env_argv(args), fds);
+    capture_from_task(p, pid, sb);
+    if (pid < 0) return capture_result(sb);
+
+    capture_status = sched_waitpid(pid);
+    return capture_result(sb);
+}
+
+// Empty p into sb until task pid (the pipe's writer) exits or closes it,
+// then close the read end. A pid that never started only closes the pipe.
+static void capture_from_task(struct pipe *p, int pid, struct strbuf *sb) {
+    if (pid <= 0 || !sb) {
+        p->read_open = 0;
+        p->write_open = 0;
+        return;
+    }
+    for (;;) {
+        capture_drain(p, sb);
+        struct task *t = sched_get_task(pid);
+        if (!t || t->state == TASK_ZOMBIE || !p->write_open) break;
+        __asm__ volatile ("hlt");   // let the child run
+    }
+    capture_drain(p, sb);
+    p->read_open = 0;
+}
+
+// capture_program() for a task the caller spawned with stdout on p (the
+// last command of a C-shell pipeline): its output goes to the active
+// capture. The caller still waits for the task.
+void capture_pipe(void *p, int pid) {
+    capture_from_task((struct pipe *)p, pid, capture_sb);
+}
+
+int capture_exit_code(void) {
+    return capture_status;
+}
+
+// s without trailing newlines; s itself when it has none
+char* str_trim_newlines(const char* s) {
+    int len = strlen(s);
+    int end = len;
+    while (end > 0 && (s[end - 1] == '\n' || s[end - 1] == '\r')) end--;
+    if (end == len) return (char*)s;
+    char* out = malloc(end + 1);
+    if (!out) return "";
+    memcpy(out, s, end);
+    out[end] = '\0';
+    return out;
+}
+
+// ============================================================================
+// Glob expansion: *, ? and [...] in path arguments
+// ============================================================================
+//
+// glob_expand(pattern) walks the pattern one '/' component at a time.
+// Literal components are resolved directly; a component with wildcards is
+// compiled once into a glob_pattern and matched against each candidate
+// directory in a single vfs_readdir pass. Matches are sorted and read back
+// with glob_result(i). Names starting with '.' only match a pattern that
+// starts with '.' too.
+
+#define GLOB_MAX_OPS 64
+#define GLOB_MAX_CLASSES 8
+
+enum { GLOB_LIT, GLOB_ANY, GLOB_STAR, GLOB_CLASS };
+
+struct glob_op {
+    uint8_t type;
+    uint8_t arg;    // the character (GLOB_LIT) or class index (GLOB_CLASS)
+};
+
+struct glob_pattern {
+    int count;
+    int classes_used;
+    struct glob_op ops[GLOB_MAX_OPS];
+    uint8_t classes[GLOB_MAX_CLASSES][32];  // 256-bit membership sets
+};
+
+struct glob_list {
+    char **items;
+    int count;
+    int cap;
+};
+
+static struct glob_list glob_results;
+
+static int glob_magic(const char *s, int len) {
+    for (int i = 0; i < len; i++) {
+        if (s[i] == '*' || s[i] == '?' || s[i] == '[') return 1;
+        if (s[i] == '\\' && i + 1 < len) i++;
+    }
+    return 0;
+}
+
+int glob_has_magic(const char *s) {
+    return glob_magic(s, strlen(s));
+}
+
+// Parse [...] starting after the '['; returns the index past ']' or -1 if
+// the bracket is unterminated (it is then an ordinary character)
+static int glob_compile_class(const char *pat, int i, int len, uint8_t *set) {
+    memset(set, 0, 32);
+    int negate = 0;
+    if (i < len && (pat[i] == '!' || pat[i] == '^')) {
+        negate = 1;
+        i++;
+    }
+    int first = 1;
+    while (i < len && (pat[i] != ']' || first)) {
+        unsigned char lo = (unsigned char)pat[i];
+        unsigned char hi = lo;
+        if (i + 2 < len && pat[i + 1] == '-' && pat[i + 2] != ']') {
+            hi = (unsigned char)pat[i + 2];
+            i += 2;
+        }
+        for (int c = lo; c <= hi; c++) set[c >> 3] |= (uint8_t)(1 << (c & 7));
+        i++;
+        first = 0;
+    }
+    if (i >= len) return -1;
+    if (negate) {
+        for (int k = 0; k < 32; k++) set[k] = (uint8_t)~set[k];
+    }
+    return i + 1;
+}
+
+static int glob_compile(const char *pat, int len, struct glob_pattern *g) {
+    g->count = 0;
+    g->classes_used = 0;
+    int i = 0;
+    while (i < len) {
+        if (g->count == GLOB_MAX_OPS) return -1;
+        struct glob_op *op = &g->ops[g->count];
+        char c = pat[i];
+        if (c == '*') {
+            i++;
+            // ** is the same as * within one component
+            if (g->count > 0 && g->ops[g->count - 1].type == GLOB_STAR) continue;
+            op->type = GLOB_STAR;
+        } else if (c == '?') {
+            op->type = GLOB_ANY;
+            i++;
+        } else if (c == '[' && g->classes_used < GLOB_MAX_CLASSES) {
+            int end = glob_compile_class(pat, i + 1, len, g->classes[g->classes_used]);
+            if (end < 0) {
+                op->type = GLOB_LIT;
+                op->arg = '[';
+                i++;
+            } else {
+                op->type = GLOB_CLASS;
+                op->arg = (uint8_t)g->classes_used++;
+                i = end;
+            }
+        } else {
+            if (c == '\\' && i + 1 < len) i++;
+            op->type = GLOB_LIT;
+            op->arg = (uint8_t)pat[i];
+            i++;
+        }
+        g->count++;
+    }
+    return 0;
+}
+
+// Iterative match: on a mismatch, retry from the most recent '*' with it
+// absorbing one more character. Linear for patterns with a single star.
+static int glob_match(const struct glob_pattern *g, const char *s) {
+    int p = 0;
+    int star_p = -1;
+    const char *star_s = 0;
+    while (*s) {
+        if (p < g->count) {
+            const struct glob_op *op = &g->ops[p];
+            unsigned char c = (unsigned char)*s;
+            if (op->type == GLOB_STAR) {
+                star_p = p++;
+                star_s = s;
+                continue;
+            }
+            if (op->type == GLOB_ANY ||
+                (op->type == GLOB_LIT && op->arg == c) ||
+                (op->type == GLOB_CLASS && (g->classes[op->arg][c >> 3] & (1 << (c & 7))))) {
+                p++;
+                s++;
+                continue;
+            }
+        }
+        if (star_p < 0) return 0;
+        p = star_p + 1;
+        s = ++star_s;
+    }
+    while (p < g->count && g->ops[p].type == GLOB_STAR) p++;
+    return p == g->count;
+}
+
+static int glob_push(struct glob_list *list, char *path) {
+    if (list->count == list->cap) {
+        int cap = list->cap ? list->cap * 2 : 16;
+        char **items = (char **)malloc(cap * (int)sizeof(char *));
+        if (!items) return -1;
+        for (int i = 0; i < list->count; i++) items[i] = list->items[i];
+        list->items = items;
+        list->cap = cap;
+    }
+    list->items[list->count++] = path;
+    return 0;
+}
+
+// base + "/" + name[0..len), as the user would write it ("" base = cwd)
+static char *glob_join(const char *base, const char *name, int len) {
+    int base_len = strlen(base);
+    int slash = base_len > 0 && base[base_len - 1] != '/';
+    char *out = malloc(base_len + slash + len + 1);
+    if (!out) return (char *)0;
+    memcpy(out, base, base_len);
+    if (slash) out[base_len] = '/';
+    memcpy(out + base_len + slash, name, len);
+    out[base_len + slash + len] = '\0';
+    return out;
+}
+
+static struct vfs_node *glob_resolve(const char *path) {
+    char full[VFS_MAX_PATH];
+    if (absolute_path(path, full) != 0) return (struct vfs_node *)0;
+    return vfs_resolve_path(full);
+}
+
+static void glob_sort(char **items, int count) {
+    if (count < 2) return;
+    char **tmp = (char **)malloc(count * (int)sizeof(char *));
+    if (!tmp) return;
+    // Bottom-up merge sort: stable, O(n log n) for large directories
+    for (int width = 1; width < count; width *= 2) {
+        for (int lo = 0; lo < count; lo += 2 * width) {
+            int mid = lo + width < count ? lo + width : count;
+            int hi = lo + 2 * width < count ? lo + 2 * width : count;
+            int a = lo, b = mid, k = lo;
+            while (a < mid && b < hi) tmp[k++] = strcmp(items[b], items[a]) < 0 ? items[b++] : items[a++];
+            while (a < mid) tmp[k++] = items[a++];
+            while (b < hi) tmp[k++] = items[b++];
+        }
+        for (int i = 0; i < count; i++) items[i] = tmp[i];
+    }
+}
+
+// Expand pattern; returns the number of matches (0 if it has no wildcards
+// or nothing matched - the caller then keeps the word as written)
+int glob_expand(const char *pattern) {
+    glob_results.items = (char **)0;
+    glob_results.count = 0;
+    glob_results.cap = 0;
+    if (!glob_has_magic(pattern)) return 0;
+
+    struct glob_list cur = { (char **)0, 0, 0 };
+    glob_push(&cur, pattern[0] == '/' ? "/" : "");
+
+    struct glob_pattern compiled;
+    int i = 0;
+    while (pattern[i] == '/') i++;
+    while (pattern[i] && cur.count > 0) {
+        int start = i;
+        while (pattern[i] && pattern[i] != '/') i++;
+        int len = i - start;
+        while (pattern[i] == '/') i++;
+        int last = pattern[i] == '\0';
+        const char *comp = pattern + start;
+
+        struct glob_list next = { (char **)0, 0, 0 };
+        if (!glob_magic(comp, len)) {
+            // Literal component: look it up, no directory scan
+            for (int b = 0; b < cur.count; b++) {
+                char *path = glob_join(cur.items[b], comp, len);
+                struct vfs_node *node = path ? glob_resolve(path) : (struct vfs_node *)0;
+                if (node && (last || (node->flags & VFS_DIRECTORY))) glob_push(&next, path);
+            }
+        } else {
+            if (glob_compile(comp, len, &compiled) != 0) return 0;
+            int dotfiles = comp[0] == '.';
+            for (int b = 0; b < cur.count; b++) {
+                struct vfs_node *dir = glob_resolve(cur.items[b]);
+                if (!dir || !(dir->flags & VFS_DIRECTORY)) continue;
+                struct dirent *entry;
+                for (uint32_t index = 0; (entry = vfs_readdir(dir, index)) != (void *)0; index++) {
+                    const char *name = entry->name;
+                    if (name[0] == '.' && !dotfiles) continue;
+                    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+                    if (!glob_match(&compiled, name)) continue;
+                    char *path = glob_join(cur.items[b], name, strlen(name));
+                    if (!path) continue;
+                    if (!last) {
+                        struct vfs_node *child = glob_resolve(path);
+                        if (!child || !(child->flags & VFS_DIRECTORY)) continue;
+                    }
+                    glob_push(&next, path);
+                }
+            }
+        }
+        cur = next;
+    }
+
+    glob_sort(cur.items, cur.count);
+    glob_results = cur;
+    return cur.count;
+}
+
+char *glob_result(int index) {
+    if (index < 0 || index >= glob_results.count) return "";
+    return glob_results.items[index];
+}
+
+// ============================================================================
+// Tree walks: find, du, cp -r, rm -r, mkdir -p
+// ============================================================================
+//
+// walk_begin()/walk_next() visit a tree iteratively: an explicit stack of
+// (directory, next readdir index, path length) frames replaces recursion,
+// and a single path buffer is extended with each entry's name and cut back
+// to the parent's length afterwards. Memory is fixed at WALK_MAX_DEPTH
+// frames; deeper directories and over-long paths are skipped and counted.
+// With post set, every directory is visited again (w->post = 1) once its
+// contents are done, which is the order removal and size totals need.
+
+#define WALK_MAX_DEPTH 32
+#define WALK_COPY_CHUNK 512
+
+enum { WALK_ANY, WALK_FILES, WALK_DIRS };
+
+struct walk_frame {
+    struct vfs_node *dir;
+    uint32_t index;
+    int path_len;
+};
+
+struct walk {
+    struct walk_frame stack[WALK_MAX_DEPTH];
+    int depth;                  // frames in use; entries are at depth
+    char path[VFS_MAX_PATH];
+    struct vfs_node *node;      // current entry
+    int post;                   // current entry is a directory being left
+    int want_post;
+    int started;
+    int skipped;
+};
+
+static int walk_begin(struct walk *w, const char *path, int want_post) {
+    memset(w, 0, sizeof(*w));
+    w->want_post = want_post;
+    if (absolute_path(path, w->path) != 0) return -1;
+    w->node = vfs_resolve_path(w->path);
+    return w->node ? 0 : -1;
+}
+
+static void walk_push(struct walk *w) {
+    if (w->depth == WALK_MAX_DEPTH) {
+        w->skipped++;
+        return;
+    }
+    struct walk_frame *f = &w->stack[w->depth++];
+    f->dir = w->node;
+    f->index = 0;
+    f->path_len = strlen(w->path);
+}
+
+// Advance to the next entry; 0 when the walk is over
+static int walk_next(struct walk *w) {
+    if (!w->started) {
+        // The root itself comes first
+        w->started = 1;
+        return 1;
+    }
+    if ((w->node->flags & VFS_DIRECTORY) && !w->post) walk_push(w);
+    w->post = 0;
+
+    while (w->depth > 0) {
+        struct walk_frame *f = &w->stack[w->depth - 1];
+        w->path[f->path_len] = '\0';
+        struct dirent *entry = vfs_readdir(f->dir, f->index);
+        if (!entry) {
+            w->depth--;
+            if (w->want_post) {
+                w->node = f->dir;
+                w->post = 1;
+                return 1;
+            }
+            continue;
+        }
+        f->index++;
+        if (strcmp(entry->name, ".") == 0 || strcmp(entry->name, "..") == 0) continue;
+
+        int name_len = strlen(entry->name);
+        int slash = f->path_len > 1;
+        if (f->path_len + slash + name_len >= VFS_MAX_PATH) {
+            w->skipped++;
+            continue;
+        }
+        if (slash) w->path[f->path_len] = '/';
+        memcpy(w->path + f->path_len + slash, entry->name, name_len + 1);
+        w->node = vfs_resolve_path(w->path);
+        if (w->node) return 1;
+    }
+    return 0;
+}
+
+// The current entry was deleted: read its parent's same index again
+static void walk_unlinked(struct walk *w) {
+    if (w->depth > 0 && w->stack[w->depth - 1].index > 0) w->stack[w->depth - 1].index--;
+}
+
+static void walk_report_skipped(const char *who, struct walk *w) {
+    if (w->skipped == 0) return;
+    mt_print(who);
+    mt_print(": skipped ");
+    print_int(w->skipped);
+    mt_print(" entries (too deep or path too long)\n");
+}
+
+static const char *walk_basename(const char *path) {
+    const char *base = path;
+    for (const char *p = path; *p; p++) {
+        if (*p == '/' && p[1]) base = p + 1;
+    }
+    return base;
+}
+
+// find: print every path under root whose name matches pattern (all if
+// empty) and whose type matches (WALK_FILES / WALK_DIRS)
+int fs_find(const char *root, const char *pattern, int type) {
+    struct walk w;
+    if (walk_begin(&w, root, 0) != 0) {
+        mt_print("find: no such path: ");
+        mt_print(root);
+        mt_print("\n");
+        return 1;
+    }
+    struct glob_pattern compiled;
+    int filter = pattern && pattern[0];
+    if (filter && glob_compile(pattern, strlen(pattern), &compiled) != 0) {
+        mt_print("find: pattern too long\n");
+        return 1;
+    }
+
+    while (walk_next(&w)) {
+        int is_dir = (w.node->flags & VFS_DIRECTORY) != 0;
+        if (type == WALK_FILES && is_dir) continue;
+        if (type == WALK_DIRS && !is_dir) continue;
+        if (filter && !glob_match(&compiled, walk_basename(w.path))) continue;
+        mt_print(w.path);
+        mt_print("\n");
+    }
+    walk_report_skipped("find", &w);
+    return 0;
+}
+
+static void du_line(uint32_t bytes, const char *path) {
+    print_int((int)bytes);
+    mt_print("\t");
+    mt_print(path);
+    mt_print("\n");
+}
+
+// du: bytes under each directory (only the total with summary set)
+int fs_du(const char *root, int summary) {
+    struct walk w;
+    if (walk_begin(&w, root, 1) != 0) {
+        mt_print("du: no such path: ");
+        mt_print(root);
+        mt_print("\n");
+        return 1;
+    }
+    // totals[d]: bytes so far in the directory at stack depth d; a
+    // directory read from the deepest frame clears totals[WALK_MAX_DEPTH + 1]
+    uint32_t totals[WALK_MAX_DEPTH + 2];
+    memset(totals, 0, sizeof(totals));
+
+    while (walk_next(&w)) {
+        if (w.node->flags & VFS_DIRECTORY) {
+            if (!w.post) {
+                totals[w.depth + 1] = 0;
+                continue;
+            }
+            uint32_t bytes = totals[w.depth + 1];
+            if (w.depth > 0) totals[w.depth] += bytes;
+            if (!summary || w.depth == 0) du_line(bytes, w.path);
+        } else {
+            if (w.depth == 0) {
+                // du of a single file
+                du_line(w.node->size, w.path);
+            } else {
+                totals[w.depth] += w.node->size;
+            }
+        }
+    }
+    walk_report_skipped("du", &w);
+    return 0;
+}
+
+static int fs_copy_file(struct vfs_node *src, const char *dst) {
+    int fd = file_open(dst, FILE_CREATE | FILE_TRUNCATE);
+    if (fd < 0) return -1;
+    char chunk[WALK_COPY_CHUNK];
+    uint32_t offset = 0;
+    int status = 0;
+    while (offset < src->size) {
+        int n = vfs_read(src, offset, WALK_COPY_CHUNK, (uint8_t *)chunk);
+        if (n <= 0 || file_pwrite(fd, chunk, n, (int)offset) != n) {
+            status = -1;
+            break;
+        }
+        offset += n;
+    }
+    file_close(fd);
+    return status;
+}
+
+// cp [-r]: copy src to dst (into dst/<name> when dst is a directory).
+// Directories need recursive; each is created once, each file is written
+// through one handle with a single size flush.
+int fs_copy(const char *src, const char *dst, int recursive) {
+    struct walk w;
+    if (walk_begin(&w, src, 0) != 0) {
+        mt_print("cp: no such path: ");
+        mt_print(src);
+        mt_print("\n");
+        return 1;
+    }
+    if ((w.node->flags & VFS_DIRECTORY) && !recursive) {
+        mt_print("cp: ");
+        mt_print(src);
+        mt_print(" is a directory (use -r)\n");
+        return 1;
+    }
+
+    char target[VFS_MAX_PATH];
+    if (absolute_path(dst, target) != 0) return 1;
+    struct vfs_node *existing = vfs_resolve_path(target);
+    int base_len = strlen(target);
+    if (existing && (existing->flags & VFS_DIRECTORY)) {
+        const char *name = walk_basename(w.path);
+        int name_len = strlen(name);
+        if (base_len + 1 + name_len >= VFS_MAX_PATH) return 1;
+        if (base_len > 1) target[base_len++] = '/';
+        memcpy(target + base_len, name, name_len + 1);
+        base_len += name_len;
+    }
+    // Opening the target truncates it, which would erase the source first
+    if (!(w.node->flags & VFS_DIRECTORY)) {
+        if (strcmp(target, w.path) == 0 || vfs_resolve_path(target) == w.node) {
+            mt_print("cp: '");
+            mt_print(src);
+            mt_print("' and '");
+            mt_print(dst);
+            mt_print("' are the same file\n");
+            return 1;
+        }
+    }
+    // Copying a directory into itself would never end
+    int src_len = strlen(w.path);
+    if (w.node->flags & VFS_DIRECTORY) {
+        int inside = 1;
+        for (int i = 0; i < src_len && inside; i++) inside = target[i] == w.path[i];
+        if (inside && (target[src_len] == '/' || target[src_len] == '\0')) {
+            mt_print("cp: cannot copy a directory into itself\n");
+            return 1;
+        }
+    }
+
+    int status = 0;
+    while (walk_next(&w)) {
+        // Same relative path under target
+        const char *rel = w.path + src_len;
+        int rel_len = strlen(rel);
+        if (base_len + rel_len >= VFS_MAX_PATH) {
+            w.skipped++;
+            continue;
+        }
+        memcpy(target + base_len, rel, rel_len + 1);
+
+        if (w.node->flags & VFS_DIRECTORY) {
+            if (!ensure_path_exists(target)) {
+                mt_print("cp: cannot create ");
+                mt_print(target);
+                mt_print("\n");
+                status = 1;
+            }
+        } else if (fs_copy_file(w.node, target) != 0) {
+            mt_print("cp: cannot write ");
+            mt_print(target);
+            mt_print("\n");
+            status = 1;
+        }
+    }
+    walk_report_skipped("cp", &w);
+    return status;
+}
+
+// rm [-r]: the VFS has no unlink call, so each entry is handed to
+// /apps/rm or /apps/rmdir - but the tree is walked once, here, contents
+// before their directory
+int fs_remove(const char *path, int recursive) {
+    struct walk w;
+    if (walk_begin(&w, path, 1) != 0) {
+        mt_print("rm: no such path: ");
+        mt_print(path);
+        mt_print("\n");
+        return 1;
+    }
+    if ((w.node->flags & VFS_DIRECTORY) && !recursive) {
+        mt_print("rm: ");
+        mt_print(path);
+        mt_print(" is a directory (use -r)\n");
+        return 1;
+    }
+
+    int status = 0;
+    while (walk_next(&w)) {
+        int is_dir = (w.node->flags & VFS_DIRECTORY) != 0;
+        if (is_dir && !w.post) continue;
+
+        char *argv[3];
+        argv[0] = is_dir ? "rmdir" : "rm";
+        argv[1] = w.path;
+        argv[2] = (char *)0;
+        int code = exec_program(is_dir ? "/apps/rmdir" : "/apps/rm", argv);
+        if (code != 0 || vfs_resolve_path(w.path)) {
+            if (code != 0) status = 1;
+            continue;
+        }
+        walk_unlinked(&w);
+    }
+    walk_report_skipped("rm", &w);
+    return status;
+}
+
+// mkdir [-p]: create path; with parents, missing parents too. Existing
+// directories are left alone, so each directory is created exactly once.
+int fs_mkdir(const char *path, int parents) {
+    char full[VFS_MAX_PATH];
+    if (absolute_path(path, full) != 0) return 1;
+    struct vfs_node *node = vfs_resolve_path(full);
+    if (node) {
+        if (node->flags & VFS_DIRECTORY) {
+            if (parents) return 0;
+            mt_print("mkdir: already exists: ");
+        } else {
+            mt_print("mkdir: not a directory: ");
+        }
+        mt_print(path);
+        mt_print("\n");
+        return 1;
+    }
+    if (!parents) {
+        // absolute_path() output always starts with '/'
+        int slash = 0;
+        for (int i = 1; full[i]; i++) {
+            if (full[i] == '/') slash = i;
+        }
+        full[slash] = '\0';
+        struct vfs_node *parent = vfs_resolve_path(slash ? full : "/");
+        full[slash] = '/';
+        if (!parent || !(parent->flags & VFS_DIRECTORY)) {
+            mt_print("mkdir: no such directory for ");
+            mt_print(path);
+            mt_print(" (use -p)\n");
+            return 1;
+        }
+    }
+    if (!ensure_path_exists(full)) {
+        mt_print("mkdir: failed to create directory: ");
+        mt_print(path);
+        mt_print("\n");
+        return 1;
+    }
+    return 0;
 }
@@ -23,6 +23,35 @@ extern char* list_dir(const char* path);
 extern char* read_file(const char* path);
 extern void cursor_get(int *row, int *col);
 extern void set_cursor(int row, int col);
+extern void console_flush(void);
+extern int console_buffering(int on);
+extern int heap_mark(void);
+extern void heap_release(int mark);
+extern void *capture_begin(void);
+extern char *capture_end(void *prev);
+extern char *capture_program(const char *path, char **args);
+extern int capture_exit_code(void);
+extern int capture_active(void);
+extern void capture_pipe(void *pipe, int pid);
+extern int glob_has_magic(const char *s);
+extern int glob_expand(const char *pattern);
+extern char *glob_result(int index);
+extern int env_set(const char *name, const char *value);
+extern int env_unset(const char *name);
+extern const char *env_entries(void);
+extern char **env_argv(char **argv);
+extern int fs_find(const char *root, const char *pattern, int type);
+extern int fs_du(const char *root, int summary);
+extern int fs_copy(const char *src, const char *dst, int recursive);
+extern int fs_remove(const char *path, int recursive);
+extern int fs_mkdir(const char *path, int parents);
+
+// Heap instrumentation from lib.c
+extern void heap_print_stats(void);
+extern void heap_stats_reset(void);
+extern void heap_snapshot(void);
+extern void heap_print_diff(void);
+extern const char* heap_set_tag(const char* tag);
 
 // Console width used by line editor positioning
 #define VGA_WIDTH 80
@@ -50,6 +79,10 @@ static int str_eq(const char* a, const char* b) {
     return *a == *b;
 }
 
+static void str_cpy(char* dst, const char* src) {
+    while ((*dst++ = *src++)) {}
+}
+
 static int str_starts_with(const char* str, const char* prefix) {
     if (!str || !prefix) return 0;
     while (*prefix) {
@@ -101,11 +134,21 @@ static int cmd_help(void) {
     mt_print("  echo [text] - print text\n");
     mt_print("  ls [path]   - list directory\n");
     mt_print("  cd <path>   - change directory\n");
-    mt_print("  mkdir <dir> - create directory\n");
+    mt_print("  mkdir [-p] <dir>... - create directories (and parents)\n");
+    mt_print("  find [path] [-name pat] [-type f|d] - list a tree\n");
+    mt_print("  du [-s] [path] - bytes used per directory\n");
+    mt_print("  cp [-r] <src> <dst> - copy files or trees\n");
+    mt_print("  rm [-r] <path>... - remove files or trees\n");
     mt_print("  pwd         - print working directory\n");
     mt_print("  clear       - clear screen\n");
+    mt_print("  ps          - list tasks\n");
+    mt_print("  top [ticks] - per-task CPU share\n");
+    mt_print("  meminfo [cmd] - heap usage (or delta around cmd)\n");
+    mt_print("  source [-e] <file> - run commands from file\n");
+    mt_print("  export [NAME=val] - set or list the program environment\n");
+    mt_print("  unset <NAME> - remove from the program environment\n");
     mt_print("  exit        - exit shell\n");
-    mt_print("External: cat, touch, rm, rmdir\n");
+    mt_print("External: cat, touch, rmdir\n");
     return 0;
 }
 
@@ -150,9 +193,49 @@ static int cmd_cd(const char* path) {
     return result;
 }
 
+// export [NAME=value ...]: add to the environment programs are started
+// with, or list it. unset NAME ...: remove from it.
+static int cmd_export(const char* args, int remove) {
+    if (!args || args[0] == '\0') {
+        if (remove) return 0;
+        for (const char *e = env_entries(); *e; e += str_len(e) + 1) {
+            mt_print(e);
+            mt_print("\n");
+        }
+        return 0;
+    }
+
+    int status = 0;
+    int i = 0;
+    while (args[i]) {
+        while (args[i] == ' ' || args[i] == '\t') i++;
+        if (!args[i]) break;
+
+        char word[128];
+        int n = 0;
+        int eq = -1;
+        while (args[i] && args[i] != ' ' && args[i] != '\t') {
+            if (args[i] == '=' && eq < 0) eq = n;
+            if (n < 127) word[n++] = args[i];
+            i++;
+        }
+        word[n] = '\0';
+
+        if (remove) {
+            env_unset(word);
+        } else if (eq > 0) {
+            word[eq] = '\0';
+            if (env_set(word, word + eq + 1) != 0) {
+                mt_print("export: environment full\n");
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
+
 extern void clear_screen(void);
 extern void set_cursor(int row, int col);
-extern struct vfs_node *ensure_path_exists(const char *path);
 extern volatile uint64_t system_ticks;
 
 static int cmd_clear(void) {
@@ -161,48 +244,231 @@ static int cmd_clear(void) {
     return 0;
 }
 
-static int cmd_mkdir(const char* path) {
-    if (!path || path[0] == '\0') {
+// Split the next whitespace-separated word of args into word; returns the
+// position after it (args is the single string programs receive)
+static int next_word(const char *args, int i, char *word, int size) {
+    while (args[i] == ' ' || args[i] == '\t') i++;
+    int n = 0;
+    while (args[i] && args[i] != ' ' && args[i] != '\t') {
+        if (n < size - 1) word[n++] = args[i];
+        i++;
+    }
+    word[n] = '\0';
+    return i;
+}
+
+static int cmd_mkdir(const char* args) {
+    char word[256];
+    int parents = 0, count = 0, status = 0;
+    int i = 0;
+    while (1) {
+        i = next_word(args, i, word, sizeof(word));
+        if (word[0] == '\0') break;
+        if (str_eq(word, "-p")) {
+            parents = 1;
+            continue;
+        }
+        count++;
+        if (fs_mkdir(word, parents) != 0) status = 1;
+    }
+    if (count == 0) {
         mt_print("mkdir: missing directory argument\n");
         return 1;
     }
-    
-    // Build full path if relative
-    char full_path[256];
-    if (path[0] == '/') {
-        // Absolute path
-        int i = 0;
-        while (path[i] && i < 255) {
-            full_path[i] = path[i];
-            i++;
-        }
-        full_path[i] = '\0';
-    } else {
-        // Relative path - prepend cwd
-        char* cwd = get_cwd();
-        int i = 0;
-        while (cwd[i] && i < 200) {
-            full_path[i] = cwd[i];
-            i++;
+    return status;
+}
+
+// find [path] [-name pattern] [-type f|d]
+static int cmd_find(const char *args) {
+    char word[256], root[256], pattern[128];
+    int type = 0;
+    root[0] = '.';
+    root[1] = '\0';
+    pattern[0] = '\0';
+    int i = 0;
+    while (1) {
+        i = next_word(args, i, word, sizeof(word));
+        if (word[0] == '\0') break;
+        if (str_eq(word, "-name")) {
+            i = next_word(args, i, pattern, sizeof(pattern));
+        } else if (str_eq(word, "-type")) {
+            i = next_word(args, i, word, sizeof(word));
+            if (str_eq(word, "f")) type = 1;
+            else if (str_eq(word, "d")) type = 2;
+            else {
+                mt_print("find: -type takes f or d\n");
+                return 1;
+            }
+        } else {
+            str_cpy(root, word);
         }
-        // Add separator if needed
-        if (i > 0 && full_path[i-1] != '/') {
-            full_path[i++] = '/';
+    }
+    return fs_find(root, pattern, type);
+}
+
+// du [-s] [path]
+static int cmd_du(const char *args) {
+    char word[256], root[256];
+    int summary = 0;
+    root[0] = '.';
+    root[1] = '\0';
+    int i = 0;
+    while (1) {
+        i = next_word(args, i, word, sizeof(word));
+        if (word[0] == '\0') break;
+        if (str_eq(word, "-s")) summary = 1;
+        else str_cpy(root, word);
+    }
+    return fs_du(root, summary);
+}
+
+// cp [-r] src dst, rm [-r] path...
+static int cmd_tree_op(const char *name, const char *args) {
+    char word[256], first[256], second[256];
+    int recursive = 0, count = 0, status = 0;
+    int copy = str_eq(name, "cp");
+    int i = 0;
+    while (1) {
+        i = next_word(args, i, word, sizeof(word));
+        if (word[0] == '\0') break;
+        if (str_eq(word, "-r") || str_eq(word, "-R")) {
+            recursive = 1;
+            continue;
         }
-        int j = 0;
-        while (path[j] && i < 255) {
-            full_path[i++] = path[j++];
+        if (copy) {
+            // Nothing is copied until both operands (and only two) are known
+            if (count == 0) str_cpy(first, word);
+            else if (count == 1) str_cpy(second, word);
+            count++;
+        } else {
+            count++;
+            if (fs_remove(word, recursive) != 0) status = 1;
         }
-        full_path[i] = '\0';
     }
-    
-    struct vfs_node *result = ensure_path_exists(full_path);
-    if (!result) {
-        mt_print("mkdir: failed to create directory: ");
-        mt_print(path);
-        mt_print("\n");
+    if (count == 0 || (copy && count != 2)) {
+        mt_print(copy ? "usage: cp [-r] <src> <dst>\n" : "usage: rm [-r] <path>...\n");
         return 1;
     }
+    if (copy) status = fs_copy(first, second, recursive);
+    return status;
+}
+
+// ============================================================================
+// Process inspection: ps, top
+// ============================================================================
+
+extern int task_max_pid(void);
+extern int task_query(int pid, int *pgid, int *state, uint64_t *ticks);
+extern const char *task_state_name(int state);
+
+// Default top refresh interval in PIT ticks (~1 sec)
+#define TOP_INTERVAL_TICKS 18
+#define TOP_MAX_PID 256
+
+// Right-align n in a field of the given width
+static void print_padded_int(int n, int width) {
+    int digits = (n <= 0) ? 1 : 0;
+    for (int v = n; v != 0; v /= 10) digits++;
+    for (int i = digits; i < width; i++) print_char(' ');
+    print_int(n);
+}
+
+static void print_padded_str(const char *s, int width) {
+    int len = str_len(s);
+    mt_print(s);
+    for (int i = len; i < width; i++) print_char(' ');
+}
+
+static int cmd_ps(void) {
+    mt_print("  PID  PGID STATE       TICKS\n");
+    int max_pid = task_max_pid();
+    for (int pid = 1; pid <= max_pid; pid++) {
+        int pgid, state;
+        uint64_t ticks;
+        if (task_query(pid, &pgid, &state, &ticks) != 0) continue;
+        print_padded_int(pid, 5);
+        print_padded_int(pgid, 6);
+        print_char(' ');
+        print_padded_str(task_state_name(state), 6);
+        print_padded_int((int)ticks, 11);
+        mt_print("\n");
+    }
+    return 0;
+}
+
+// Previous-sample runtime per pid; static so refreshes never allocate
+static uint64_t top_prev_ticks[TOP_MAX_PID + 1];
+static uint8_t top_prev_valid[TOP_MAX_PID + 1];
+
+static int top_parse_interval(const char *args) {
+    int n = 0;
+    for (int i = 0; args && args[i] >= '0' && args[i] <= '9'; i++) {
+        n = n * 10 + (args[i] - '0');
+    }
+    return n > 0 ? n : TOP_INTERVAL_TICKS;
+}
+
+// Block until the interval elapses. Returns 1 if a key was pressed (quit).
+static int top_wait(uint64_t deadline) {
+    while (system_ticks < deadline) {
+        struct key_event ev;
+        if (keyboard_poll_event(&ev)) {
+            if (ev.pressed) return 1;
+            continue;
+        }
+        __asm__ volatile ("hlt");
+    }
+    return 0;
+}
+
+// top [interval-ticks]: refresh per-task CPU share until a key is pressed
+static int cmd_top(const char *args) {
+    int interval = top_parse_interval(args);
+    int max_pid = task_max_pid();
+    if (max_pid > TOP_MAX_PID) max_pid = TOP_MAX_PID;
+
+    // Baseline sample, so the first frame already shows real deltas
+    for (int pid = 0; pid <= max_pid; pid++) {
+        int pgid, state;
+        uint64_t ticks;
+        top_prev_valid[pid] = task_query(pid, &pgid, &state, &ticks) == 0;
+        top_prev_ticks[pid] = top_prev_valid[pid] ? ticks : 0;
+    }
+    uint64_t prev_time = system_ticks;
+
+    while (1) {
+        if (top_wait(prev_time + interval)) break;
+
+        uint64_t now = system_ticks;
+        int elapsed = (int)(now - prev_time);
+        if (elapsed <= 0) elapsed = 1;
+        prev_time = now;
+
+        cmd_clear();
+        mt_print("top - interval ");
+        print_int(elapsed);
+        mt_print(" ticks, any key to quit\n");
+        mt_print("  PID  PGID STATE    CPU%       TICKS\n");
+        for (int pid = 1; pid <= max_pid; pid++) {
+            int pgid, state;
+            uint64_t ticks;
+            if (task_query(pid, &pgid, &state, &ticks) != 0) {
+                top_prev_valid[pid] = 0;
+                continue;
+            }
+            int delta = top_prev_valid[pid] ? (int)(ticks - top_prev_ticks[pid]) : 0;
+            top_prev_ticks[pid] = ticks;
+            top_prev_valid[pid] = 1;
+
+            print_padded_int(pid, 5);
+            print_padded_int(pgid, 6);
+            print_char(' ');
+            print_padded_str(task_state_name(state), 6);
+            print_padded_int(delta * 100 / elapsed, 6);
+            print_padded_int((int)ticks, 12);
+            mt_print("\n");
+        }
+    }
     return 0;
 }
 
@@ -393,7 +659,7 @@ static int exec_redirect(const char *input, int redir_pos, int mode) {
     fds[2].type = SHELL_FD_CONSOLE;
 
     int shell_pgid = getpid();
-    int pid = sched_spawn(path, argv, (void *)fds);
+    int pid = sched_spawn(path, env_argv(argv), (void *)fds);
     if (pid < 0) {
         mt_print("redirect: command not found: ");
         mt_print(r_cmd);
@@ -415,15 +681,23 @@ static int exec_redirect(const char *input, int redir_pos, int mode) {
     return 0;
 }
 
+#define PIPELINE_MAX 4
+
 // Execute a pipeline: "cmd1 | cmd2 | cmd3"
 static int exec_pipeline(const char *input) {
     // Split input on '|' into segments
-    char segments[4][128];  // max 4 commands in pipeline
+    char segments[PIPELINE_MAX][128];
     int seg_count = 0;
     int si = 0, di = 0;
 
-    for (int i = 0; input[i] && seg_count < 4; i++) {
+    for (int i = 0; input[i]; i++) {
         if (input[i] == '|') {
+            if (seg_count == PIPELINE_MAX - 1) {
+                mt_print("bridge: pipeline too long (max ");
+                print_int(PIPELINE_MAX);
+                mt_print(" commands)\n");
+                return -1;
+            }
             segments[seg_count][di] = '\0';
             seg_count++;
             di = 0;
@@ -441,8 +715,8 @@ static int exec_pipeline(const char *input) {
     if (seg_count < 2) return -1; // not a real pipeline
 
     // Parse each segment into command + args
-    char cmds[4][64];
-    char argss[4][128];
+    char cmds[PIPELINE_MAX][64];
+    char argss[PIPELINE_MAX][128];
     for (int i = 0; i < seg_count; i++) {
         int ci = 0, ai = 0, j = 0;
         // skip whitespace
@@ -463,8 +737,8 @@ static int exec_pipeline(const char *input) {
 
     // Create pipes between consecutive commands
     // For N commands we need N-1 pipes
-    struct shell_pipe *pipes[3]; // max 3 pipes for 4 commands
-    int pipe_rfd[3], pipe_wfd[3]; // conceptual read/write FD indices
+    struct shell_pipe *pipes[PIPELINE_MAX - 1];
+    int pipe_rfd[PIPELINE_MAX - 1], pipe_wfd[PIPELINE_MAX - 1]; // conceptual read/write FD indices
     (void)pipe_rfd; (void)pipe_wfd;
 
     for (int i = 0; i < seg_count - 1; i++) {
@@ -475,8 +749,18 @@ static int exec_pipeline(const char *input) {
         }
     }
 
+    // Inside $(...) the last command writes to a pipe read into the capture
+    struct shell_pipe *capture = 0;
+    if (capture_active()) {
+        capture = (struct shell_pipe *)pipe_alloc();
+        if (!capture) {
+            mt_print("pipe: allocation failed\n");
+            return -1;
+        }
+    }
+
     // Spawn each command with appropriate FD redirections
-    int pids[4];
+    int pids[PIPELINE_MAX];
     int pipeline_pgid = 0;  // Process group for the pipeline
     for (int i = 0; i < seg_count; i++) {
         // Build path
@@ -520,7 +804,12 @@ static int exec_pipeline(const char *input) {
         }
 
         // fd 1 = stdout
-        if (i == seg_count - 1) {
+        if (i == seg_count - 1 && capture) {
+            // Last command inside $(...): stdout is the capture pipe
+            fds[1].type = SHELL_FD_PIPE;
+            fds[1].pipe = capture;
+            fds[1].flags = 1; // O_WRONLY
+        } else if (i == seg_count - 1) {
             // Last command: stdout is console
             fds[1].type = SHELL_FD_CONSOLE;
         } else {
@@ -533,7 +822,7 @@ static int exec_pipeline(const char *input) {
         // fd 2 = stderr (always console)
         fds[2].type = SHELL_FD_CONSOLE;
 
-        pids[i] = sched_spawn(path, argv, (void *)fds);
+        pids[i] = sched_spawn(path, env_argv(argv), (void *)fds);
         if (pids[i] < 0) {
             mt_print("pipe: failed to spawn: ");
             mt_print(cmds[i]);
@@ -553,6 +842,9 @@ static int exec_pipeline(const char *input) {
         tcsetpgrp(pipeline_pgid);
     }
 
+    // The captured command is read while it runs, or it blocks on a full pipe
+    if (capture) capture_pipe(capture, pids[seg_count - 1]);
+
     // Wait for all commands to finish
     for (int i = 0; i < seg_count; i++) {
         if (pids[i] > 0) {
@@ -572,10 +864,260 @@ static int exec_pipeline(const char *input) {
 
 static char input_buffer[512];
 
+// Exit status of the last command shell_execute() ran
+static int shell_status = 0;
+
+static int cmd_meminfo(const char* args);
+static int cmd_source(const char* args);
+static int shell_execute(char* input);
+
+// ============================================================================
+// Syntax highlighting for the line editor
+// ============================================================================
+//
+// The line is lexed one character at a time and the lexer state before
+// every position is kept in hl_state[], so an edit only re-lexes from the
+// nearest stable position before it (anywhere outside a bare word, whose
+// class is only known once it ends) until the new state agrees with the
+// old one again. hl_shown[] mirrors what is on screen, and hl_paint() only
+// redraws cells whose character or class changed. Colors are ANSI SGR
+// sequences.
+
+extern int keyword_id(const char* s, int start, int len);
+
+static int is_builtin(const char *name);
+static void shell_program_path(const char *name, char *out);
+
+// Highlight classes, after the token kinds of tokenizer.mtc
+enum {
+    HL_PLAIN,       // TOK_NAME in argument position
+    HL_COMMAND,     // a builtin or program in command position
+    HL_UNKNOWN,     // a command word that resolves to nothing
+    HL_KEYWORD,     // TOK_KEYWORD
+    HL_STRING,      // TOK_STRING
+    HL_NUMBER,      // TOK_INTEGER
+    HL_VARIABLE,    // TOK_VARIABLE, TOK_HOME
+    HL_OPERATOR,    // TOK_SYMBOL (| & ; < > ( )) and $(
+};
+
+static const uint8_t hl_colors[] = { 39, 32, 31, 35, 33, 33, 36, 34 };
+
+// Lexer state: mode in bits 0-2, command position in bit 3, $( depth above
+enum { HL_SPACE, HL_WORD, HL_DQUOTE, HL_SQUOTE, HL_DOLLAR, HL_VAR };
+#define HL_MODE(st) ((st) & 7)
+#define HL_STABLE(st) (HL_MODE(st) != HL_WORD && HL_MODE(st) != HL_DOLLAR)
+#define HL_CMDPOS 8
+#define HL_DEPTH_ONE 16
+
+static uint8_t hl_state[513];   // state before input_buffer[i]
+static uint8_t hl_cls[512];
+static char hl_shown[512];      // screen contents after the prompt
+static uint8_t hl_shown_cls[512];
+static int hl_shown_len = 0;
+static int hl_word_start = 0;
+
+// Last command word looked up in /apps, so typing arguments costs nothing
+static char hl_cache_name[64];
+static int hl_cache_known = 0;
+
+static void hl_reset(void) {
+    hl_state[0] = HL_SPACE | HL_CMDPOS;
+    hl_shown_len = 0;
+    hl_cache_name[0] = '\0';
+}
+
+static int hl_is_operator(char c) {
+    return c == '|' || c == '&' || c == ';' || c == '<' || c == '>' || c == '(' || c == ')';
+}
+
+static int hl_is_var_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == '?';
+}
+
+static int hl_command_known(int start, int len) {
+    if (len >= (int)sizeof(hl_cache_name)) return 0;
+    char name[64];
+    for (int i = 0; i < len; i++) name[i] = input_buffer[start + i];
+    name[len] = '\0';
+    if (is_builtin(name)) return 1;
+    if (str_eq(name, hl_cache_name)) return hl_cache_known;
+
+    char path[256];
+    shell_program_path(name, path);
+    struct vfs_node *node = vfs_resolve_path(path);
+    for (int i = 0; i <= len; i++) hl_cache_name[i] = name[i];
+    hl_cache_known = node && (node->flags & VFS_FILE);
+    return hl_cache_known;
+}
+
+// Classify the bare word input_buffer[hl_word_start..end); returns the
+// state to continue with
+static uint8_t hl_finish_word(uint8_t st, int end) {
+    int start = hl_word_start;
+    int len = end - start;
+    uint8_t cls = HL_PLAIN;
+    if (st & HL_CMDPOS) {
+        if (keyword_id(input_buffer, start, len)) {
+            cls = HL_KEYWORD;           // if/while/... keep command position
+        } else {
+            cls = hl_command_known(start, len) ? HL_COMMAND : HL_UNKNOWN;
+            st &= ~HL_CMDPOS;
+        }
+    } else if (input_buffer[start] == '~') {
+        cls = HL_VARIABLE;
+    } else {
+        cls = HL_NUMBER;
+        for (int i = start; i < end; i++) {
+            if (input_buffer[i] < '0' || input_buffer[i] > '9') { cls = HL_PLAIN; break; }
+        }
+    }
+    for (int i = start; i < end; i++) hl_cls[i] = cls;
+    return (uint8_t)((st & ~7) | HL_SPACE);
+}
+
+// Lex input_buffer[i] in state st; returns the state before i + 1
+static uint8_t hl_step(uint8_t st, int i) {
+    char c = input_buffer[i];
+    int mode = HL_MODE(st);
+
+    if (mode == HL_WORD) {
+        if (c != ' ' && c != '\t' && c != '"' && c != '\'' && c != '$' && !hl_is_operator(c)) {
+            hl_cls[i] = HL_PLAIN;       // provisional until the word ends
+            return st;
+        }
+        st = hl_finish_word(st, i);
+    } else if (mode == HL_DQUOTE || mode == HL_SQUOTE) {
+        hl_cls[i] = HL_STRING;
+        if (c == (mode == HL_DQUOTE ? '"' : '\'')) return (uint8_t)((st & ~7) | HL_SPACE);
+        return st;
+    } else if (mode == HL_DOLLAR) {
+        if (c == '(') {
+            // $( opens a command; the $ is part of the operator
+            hl_cls[i - 1] = HL_OPERATOR;
+            hl_cls[i] = HL_OPERATOR;
+            return (uint8_t)(((st & ~7) + HL_DEPTH_ONE) | HL_CMDPOS | HL_SPACE);
+        }
+        if (hl_is_var_char(c)) {
+            hl_cls[i] = HL_VARIABLE;
+            return (uint8_t)((st & ~7) | HL_VAR);
+        }
+        st = (uint8_t)((st & ~7) | HL_SPACE);
+    } else if (mode == HL_VAR) {
+        if (hl_is_var_char(c)) {
+            hl_cls[i] = HL_VARIABLE;
+            return st;
+        }
+        st = (uint8_t)((st & ~7) | HL_SPACE);
+    }
+
+    // Between tokens
+    uint8_t rest = st & ~7;
+    if (c == ' ' || c == '\t') {
+        hl_cls[i] = HL_PLAIN;
+        return st;
+    }
+    if (c == '"' || c == '\'') {
+        hl_cls[i] = HL_STRING;
+        return (uint8_t)((rest & ~HL_CMDPOS) | (c == '"' ? HL_DQUOTE : HL_SQUOTE));
+    }
+    if (c == '$') {
+        hl_cls[i] = HL_VARIABLE;
+        return (uint8_t)((rest & ~HL_CMDPOS) | HL_DOLLAR);
+    }
+    if (hl_is_operator(c)) {
+        hl_cls[i] = HL_OPERATOR;
+        if (c == ')') {
+            if (rest >= HL_DEPTH_ONE) rest -= HL_DEPTH_ONE;
+            return (uint8_t)(rest & ~HL_CMDPOS);
+        }
+        if (c == '<' || c == '>') return (uint8_t)(rest & ~HL_CMDPOS);
+        return (uint8_t)(rest | HL_CMDPOS);
+    }
+    hl_word_start = i;
+    hl_cls[i] = HL_PLAIN;
+    return (uint8_t)(rest | HL_WORD);
+}
+
+// Overlap-safe move of n entries from a[src] to a[dst]
+static void hl_move(uint8_t *a, int dst, int src, int n) {
+    if (dst > src) {
+        for (int i = n - 1; i >= 0; i--) a[dst + i] = a[src + i];
+    } else {
+        for (int i = 0; i < n; i++) a[dst + i] = a[src + i];
+    }
+}
+
+// input_buffer[at..at+inserted) replaced removed characters and the line
+// is now len long. Shifts the per-position state, re-lexes the affected
+// span and returns the first position whose class may have changed.
+static int hl_edit(int at, int removed, int inserted, int len) {
+    int old_len = len - inserted + removed;
+
+    // Back up to a position whose class does not depend on later input:
+    // not inside a bare word, and not just after a $ that may become $(
+    int start = at;
+    while (start > 0 && !HL_STABLE(hl_state[start])) start--;
+    uint8_t st = hl_state[start];
+
+    // Line up the old states and classes after the edit with their new
+    // positions, so the re-lex can tell when it is back in step
+    if (inserted != removed) {
+        int tail = old_len - (at + removed);
+        hl_move(hl_cls, at + inserted, at + removed, tail);
+        hl_move(hl_state, at + inserted, at + removed, tail + 1);
+        hl_state[start] = st;
+    }
+
+    int i = start;
+    for (; i < len; i++) {
+        st = hl_step(st, i);
+        if (i + 1 >= at + inserted && HL_STABLE(st) && st == hl_state[i + 1]) break;
+        hl_state[i + 1] = st;
+    }
+    if (i == len && HL_MODE(st) == HL_WORD) hl_finish_word(st, len);
+    return start;
+}
+
+static void hl_sgr(int code) {
+    print_char(0x1b);
+    print_char('[');
+    if (code >= 10) print_char('0' + code / 10);
+    print_char('0' + code % 10);
+    print_char('m');
+}
+
+// Redraw the cells in [from, max(len, shown)) that differ from the screen
+static void hl_paint(int row, int col, int from, int len) {
+    int end = len > hl_shown_len ? len : hl_shown_len;
+    int at = -1;
+    int color = -1;
+    for (int i = from; i < end; i++) {
+        char ch = i < len ? input_buffer[i] : ' ';
+        uint8_t cls = i < len ? hl_cls[i] : HL_PLAIN;
+        if (i < hl_shown_len && hl_shown[i] == ch && hl_shown_cls[i] == cls) continue;
+        if (at != i) {
+            int abs_pos = col + i;
+            set_cursor(row + abs_pos / VGA_WIDTH, abs_pos % VGA_WIDTH);
+        }
+        if (cls != color) {
+            hl_sgr(hl_colors[cls]);
+            color = cls;
+        }
+        print_char(ch);
+        hl_shown[i] = ch;
+        hl_shown_cls[i] = cls;
+        at = i + 1;
+    }
+    if (color >= 0) hl_sgr(0);
+    hl_shown_len = len;
+}
+
 // Cursor blink interval in PIT ticks (~18.2 ticks/sec, so 9 ≈ 0.5 sec)
 #define CURSOR_BLINK_TICKS 9
 
-// Simple line editor with cursor tracking, prompt-aware redraw, and blinking cursor.
+// Simple line editor with cursor tracking, prompt-aware redraw, blinking
+// cursor and incremental syntax highlighting.
 static char* shell_read_line(void) {
     // Capture prompt end position
     int prompt_row, prompt_col;
@@ -583,18 +1125,13 @@ static char* shell_read_line(void) {
 
     int len = 0;          // line length
     int pos = 0;          // cursor position within line
-    int rendered_len = 0; // previously drawn length
 
-    // Redraw line content (not cursor)
-    void redraw_line(void) {
-        set_cursor(prompt_row, prompt_col);
-        for (int i = 0; i < len; i++) {
-            print_char(input_buffer[i]);
-        }
-        for (int i = len; i < rendered_len; i++) {
-            print_char(' ');
-        }
-        rendered_len = len;
+    hl_reset();
+
+    // Re-highlight after an edit and redraw what changed (not the cursor)
+    void redraw_line(int at, int removed, int inserted) {
+        int from = hl_edit(at, removed, inserted, len);
+        hl_paint(prompt_row, prompt_col, from, len);
     }
 
     // Position text cursor at current edit point.
@@ -645,7 +1182,7 @@ static char* shell_read_line(void) {
                 }
                 len--;
                 pos--;
-                redraw_line();
+                redraw_line(pos, 1, 0);
             }
         } else if (ev.key == KEY_LEFT) {
             if (pos > 0) {
@@ -666,7 +1203,7 @@ static char* shell_read_line(void) {
                 input_buffer[pos] = ev.key;
                 len++;
                 pos++;
-                redraw_line();
+                redraw_line(pos - 1, 0, 1);
             }
         } else {
             continue;  // Unknown key
@@ -677,6 +1214,500 @@ static char* shell_read_line(void) {
     }
 }
 
+// ============================================================================
+// Command substitution: $(command)
+// ============================================================================
+
+static const char *shell_builtins[] = {
+    "exit", "help", "pwd", "echo", "ls", "cd", "clear", "ps", "top",
+    "meminfo", "source", ".", "export", "unset", "mkdir", "find", "du",
+    "cp", "rm", 0
+};
+
+static int is_builtin(const char *name) {
+    for (int i = 0; shell_builtins[i]; i++) {
+        if (str_eq(name, shell_builtins[i])) return 1;
+    }
+    return 0;
+}
+
+// /apps/<name> unless name is already absolute
+static void shell_program_path(const char *name, char *out) {
+    int i = 0;
+    if (name[0] != '/') {
+        const char *prefix = "/apps/";
+        while (prefix[i]) { out[i] = prefix[i]; i++; }
+    }
+    int j = 0;
+    while (name[j] && i < 255) { out[i++] = name[j++]; }
+    out[i] = '\0';
+}
+
+static int has_substitution(const char *input);
+static int expand_substitutions(const char *input, char *out, int out_size);
+static int has_glob(const char *input);
+static void expand_globs(const char *input, char *out, int out_size);
+
+// Output of one substituted command. A single external program writes to
+// a pipe (capture_program). Builtins, pipelines and redirections run
+// through shell_execute() with the console captured in-process; the last
+// command of a pipeline writes into a capture pipe (exec_pipeline), and
+// a > redirection sends its output to the file, as in sh.
+static char *shell_capture(char *inner) {
+    parse_input(inner);
+    if (cmd_buf[0] == '\0') return "";
+
+    int redir_pos = 0;
+    if (is_builtin(cmd_buf) || has_pipe(inner) || find_redirect(inner, &redir_pos)) {
+        void *prev = capture_begin();
+        shell_execute(inner);
+        return capture_end(prev);
+    }
+
+    // A lone program gets the expansions shell_execute() would apply
+    char expanded[256];
+    if (has_substitution(inner)) {
+        if (expand_substitutions(inner, expanded, sizeof(expanded)) < 0) {
+            shell_status = 1;
+            return "";
+        }
+        inner = expanded;
+    }
+    char globbed[256];
+    if (has_glob(inner)) {
+        expand_globs(inner, globbed, sizeof(globbed));
+        inner = globbed;
+    }
+    parse_input(inner);
+
+    char path[256];
+    shell_program_path(cmd_buf, path);
+    char *argv[3];
+    argv[0] = cmd_buf;
+    argv[1] = (args_buf[0] != '\0') ? args_buf : 0;
+    argv[2] = 0;
+
+    char *out = capture_program(path, argv);
+    shell_status = capture_exit_code();
+    if (shell_status == 127) {
+        mt_print("bridge: command not found: ");
+        mt_print(cmd_buf);
+        mt_print("\n");
+    }
+    return out;
+}
+
+static int has_substitution(const char *input) {
+    for (int i = 0; input[i]; i++) {
+        if (input[i] == '$' && input[i + 1] == '(') return 1;
+    }
+    return 0;
+}
+
+// Copy input to out with every $(command) replaced by the command's output
+// (trailing newlines trimmed, inner newlines turned into spaces). Returns
+// -1 if a $( is never closed.
+static int expand_substitutions(const char *input, char *out, int out_size) {
+    int o = 0;
+    int i = 0;
+    while (input[i]) {
+        if (input[i] != '$' || input[i + 1] != '(') {
+            if (o < out_size - 1) out[o++] = input[i];
+            i++;
+            continue;
+        }
+
+        int depth = 1;
+        int j = i + 2;
+        while (input[j]) {
+            if (input[j] == '(') depth++;
+            if (input[j] == ')' && --depth == 0) break;
+            j++;
+        }
+        if (!input[j]) {
+            mt_print("bridge: missing ) in $(\n");
+            return -1;
+        }
+
+        char inner[256];
+        int n = 0;
+        for (int k = i + 2; k < j && n < 255; k++) inner[n++] = input[k];
+        inner[n] = '\0';
+
+        // The captured text only needs to live until it is copied
+        int mark = heap_mark();
+        const char *text = shell_capture(inner);
+        for (; *text && o < out_size - 1; text++) {
+            out[o++] = (*text == '\n') ? ' ' : *text;
+        }
+        heap_release(mark);
+        i = j + 1;
+    }
+    out[o] = '\0';
+    return 0;
+}
+
+static int has_glob(const char *input) {
+    for (int i = 0; input[i]; i++) {
+        if (input[i] == '*' || input[i] == '?' || input[i] == '[') return 1;
+    }
+    return 0;
+}
+
+// Strip quotes and backslashes from a wildcard word into out; returns 1
+// if any were present (the word is then taken literally)
+static int glob_unquote(const char *word, char *out) {
+    int quoted = 0, n = 0;
+    char quote = 0;
+    for (int i = 0; word[i]; i++) {
+        char c = word[i];
+        if (quote) {
+            if (c == quote) { quote = 0; continue; }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            quoted = 1;
+            continue;
+        } else if (c == '\\' && word[i + 1]) {
+            c = word[++i];
+            quoted = 1;
+        }
+        out[n++] = c;
+    }
+    out[n] = '\0';
+    return quoted;
+}
+
+// Copy input to out with every word containing *, ? or [...] replaced by
+// the sorted paths it matches. A word that matches nothing is kept as
+// written. A quoted or escaped wildcard ('*.txt', \*.txt) is not expanded
+// and reaches the command without its quotes. Words end at whitespace, so
+// | and > stay separate when spaced.
+static void expand_globs(const char *input, char *out, int out_size) {
+    int o = 0;
+    int i = 0;
+    while (input[i]) {
+        if (input[i] == ' ' || input[i] == '\t') {
+            if (o < out_size - 1) out[o++] = input[i];
+            i++;
+            continue;
+        }
+
+        char word[128];
+        int n = 0;
+        while (input[i] && input[i] != ' ' && input[i] != '\t') {
+            if (n < 127) word[n++] = input[i];
+            i++;
+        }
+        word[n] = '\0';
+
+        int magic = 0;
+        if (has_glob(word)) {
+            if (glob_unquote(word, word)) n = str_len(word);
+            else magic = glob_has_magic(word);
+        }
+
+        // Match paths only need to live until they are copied
+        int mark = heap_mark();
+        int count = magic ? glob_expand(word) : 0;
+        if (count == 0) {
+            for (int k = 0; k < n && o < out_size - 1; k++) out[o++] = word[k];
+        }
+        for (int m = 0; m < count; m++) {
+            if (m > 0 && o < out_size - 1) out[o++] = ' ';
+            for (const char *p = glob_result(m); *p && o < out_size - 1; p++) out[o++] = *p;
+        }
+        heap_release(mark);
+    }
+    out[o] = '\0';
+}
+
+// Execute one input line (builtin, redirect, pipeline or external program).
+// Returns 1 when the shell should exit, 0 otherwise.
+static int shell_execute(char* input) {
+    char expanded[512];
+    if (has_substitution(input)) {
+        if (expand_substitutions(input, expanded, sizeof(expanded)) < 0) {
+            shell_status = 1;
+            return 0;
+        }
+        input = expanded;
+    }
+
+    // Expand globs before anything is parsed, so builtins, redirects and
+    // every pipeline stage see the matched paths in their arguments
+    char globbed[512];
+    if (has_glob(input)) {
+        expand_globs(input, globbed, sizeof(globbed));
+        input = globbed;
+    }
+
+    // Parse into command and arguments
+    parse_input(input);
+
+    // Empty command (just whitespace)
+    if (cmd_buf[0] == '\0') {
+        return 0;
+    }
+
+    // Check for output redirection before pipeline/builtins
+    {
+        int redir_pos = 0;
+        int redir_mode = find_redirect(input, &redir_pos);
+        if (redir_mode > 0) {
+            console_flush();
+            shell_status = exec_redirect(input, redir_pos, redir_mode) != 0;
+            return 0;
+        }
+    }
+
+    // Check for pipeline before built-in command dispatch
+    if (has_pipe(input)) {
+        console_flush();
+        shell_status = exec_pipeline(input) != 0;
+        return 0;
+    }
+
+    // Handle built-in commands
+    if (str_eq(cmd_buf, "exit")) {
+        shell_status = 0;
+        return 1;
+    } else if (str_eq(cmd_buf, "help")) {
+        shell_status = cmd_help();
+    } else if (str_eq(cmd_buf, "pwd")) {
+        shell_status = cmd_pwd();
+    } else if (str_eq(cmd_buf, "echo")) {
+        shell_status = cmd_echo(args_buf);
+    } else if (str_eq(cmd_buf, "ls")) {
+        shell_status = cmd_ls(args_buf);
+    } else if (str_eq(cmd_buf, "cd")) {
+        shell_status = cmd_cd(args_buf) != 0;
+    } else if (str_eq(cmd_buf, "clear")) {
+        shell_status = cmd_clear();
+    } else if (str_eq(cmd_buf, "export")) {
+        shell_status = cmd_export(args_buf, 0);
+    } else if (str_eq(cmd_buf, "unset")) {
+        shell_status = cmd_export(args_buf, 1);
+    } else if (str_eq(cmd_buf, "mkdir")) {
+        shell_status = cmd_mkdir(args_buf);
+    } else if (str_eq(cmd_buf, "find")) {
+        shell_status = cmd_find(args_buf);
+    } else if (str_eq(cmd_buf, "du")) {
+        shell_status = cmd_du(args_buf);
+    } else if (str_eq(cmd_buf, "cp") || str_eq(cmd_buf, "rm")) {
+        shell_status = cmd_tree_op(cmd_buf, args_buf);
+    } else if (str_eq(cmd_buf, "ps")) {
+        shell_status = cmd_ps();
+    } else if (str_eq(cmd_buf, "top")) {
+        shell_status = cmd_top(args_buf);
+    } else if (str_eq(cmd_buf, "meminfo")) {
+        return cmd_meminfo(args_buf);
+    } else if (str_eq(cmd_buf, "source") || str_eq(cmd_buf, ".")) {
+        return cmd_source(args_buf);
+    } else {
+        // Try to execute external program from /apps/<cmd>
+        char path[256];
+        shell_program_path(cmd_buf, path);
+
+        // Build argv: prog, optional single arg string, NULL
+        char *argv[3];
+        argv[0] = (char *)cmd_buf;
+        argv[1] = (args_buf && args_buf[0] != '\0') ? (char *)args_buf : 0;
+        argv[2] = 0;
+
+        int r = exec_program(path, argv);
+        shell_status = r;
+        if (r == -127) {
+            shell_status = 127;
+            mt_print("bridge: command not found: ");
+            mt_print(cmd_buf);
+            mt_print("\n");
+        } else if (r != 0) {
+            mt_print("bridge: ");
+            mt_print(cmd_buf);
+            mt_print(" exited with ");
+            print_int(r);
+            mt_print("\n");
+        }
+    }
+    return 0;
+}
+
+// meminfo           - print heap counters, histogram and per-tag usage
+// meminfo reset     - clear counters and restart the high-water mark
+// meminfo <command> - run <command> and print the heap delta it caused
+static int cmd_meminfo(const char* args) {
+    if (!args || args[0] == '\0') {
+        heap_print_stats();
+        return 0;
+    }
+    if (str_eq(args, "reset")) {
+        heap_stats_reset();
+        return 0;
+    }
+
+    // A diagnostic must not end the shell it is measuring
+    char word[16];
+    next_word(args, 0, word, sizeof(word));
+    if (str_eq(word, "exit")) {
+        mt_print("meminfo: cannot measure exit\n");
+        shell_status = 1;
+        return 0;
+    }
+
+    // shell_execute() reparses into cmd_buf/args_buf, so run from a copy
+    char inner[256];
+    int i = 0;
+    while (args[i] && i < 255) { inner[i] = args[i]; i++; }
+    inner[i] = '\0';
+
+    // A command that fails partway can leave its phase tag set; put back
+    // whatever was current so later allocations are attributed correctly
+    const char* prev_tag = heap_set_tag((const char*)0);
+    heap_set_tag(prev_tag);
+    heap_snapshot();
+    shell_execute(inner);
+    heap_set_tag(prev_tag);
+    heap_print_diff();
+    return 0;
+}
+
+// ============================================================================
+// Script runner: bridge [-e] script.sh, source [-e] file
+// ============================================================================
+
+#define SCRIPT_CHUNK 512
+#define SCRIPT_MAX_DEPTH 8
+#define SCRIPT_LINE_MAX 512
+
+static int script_depth = 0;
+
+static void script_error(const char *path, int line_no, const char *what) {
+    mt_print("bridge: ");
+    mt_print(path);
+    mt_print(": line ");
+    print_int(line_no);
+    mt_print(what);
+}
+
+// Run one script line. Returns 1 if it ran exit, -1 if the script should
+// stop because the line failed under -e, else 0. A line that did not fit
+// the buffer (too_long) is reported and never run in part.
+static int script_line(char *line, int too_long, const char *path, int line_no, int stop_on_error) {
+    if (too_long) {
+        script_error(path, line_no, ": line too long, not run\n");
+        shell_status = 1;
+        return stop_on_error ? -1 : 0;
+    }
+    int i = 0;
+    while (line[i] == ' ' || line[i] == '\t') i++;
+    if (line[i] == '\0' || line[i] == '#') return 0;
+
+    // Nothing a command allocates outlives its line
+    int mark = heap_mark();
+    int r = shell_execute(line + i);
+    heap_release(mark);
+    if (r) return 1;
+
+    if (stop_on_error && shell_status != 0) {
+        script_error(path, line_no, ": stopped, status ");
+        print_int(shell_status);
+        mt_print("\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Run every line of a file through shell_execute() with no prompt or line
+// editing, console output buffered. The file is read SCRIPT_CHUNK bytes at
+// a time, so its size is not limited by the heap. Blank lines and lines
+// starting with '#' are skipped; a line longer than SCRIPT_LINE_MAX - 1
+// bytes is reported and not run (it stops the script under -e). Returns 1
+// if the script ran exit, else 0;
+// shell_status is left at the last command's status.
+static int shell_source(const char *path, int stop_on_error) {
+    char full_path[256];
+    shell_build_path(path, full_path);
+    struct vfs_node *node = vfs_resolve_path(full_path);
+    if (!node || !(node->flags & VFS_FILE)) {
+        mt_print("source: cannot open ");
+        mt_print(path);
+        mt_print("\n");
+        shell_status = 1;
+        return 0;
+    }
+    if (script_depth >= SCRIPT_MAX_DEPTH) {
+        mt_print("source: too deeply nested: ");
+        mt_print(path);
+        mt_print("\n");
+        shell_status = 1;
+        return 0;
+    }
+
+    script_depth++;
+    int was_buffered = console_buffering(1);
+    shell_status = 0;
+
+    char chunk[SCRIPT_CHUNK];
+    char line[SCRIPT_LINE_MAX];
+    int line_len = 0;
+    int too_long = 0;
+    int line_no = 0;
+    int result = 0;
+    uint32_t offset = 0;
+    while (offset < node->size && result == 0) {
+        uint32_t want = node->size - offset;
+        if (want > SCRIPT_CHUNK) want = SCRIPT_CHUNK;
+        int n = vfs_read(node, offset, want, (uint8_t *)chunk);
+        if (n <= 0) break;
+        offset += n;
+
+        for (int i = 0; i < n && result == 0; i++) {
+            if (chunk[i] == '\n') {
+                line[line_len] = '\0';
+                line_no++;
+                result = script_line(line, too_long, path, line_no, stop_on_error);
+                line_len = 0;
+                too_long = 0;
+            } else if (chunk[i] != '\r') {
+                if (line_len < (int)sizeof(line) - 1) line[line_len++] = chunk[i];
+                else too_long = 1;
+            }
+        }
+    }
+    if (result == 0 && (line_len > 0 || too_long)) {
+        line[line_len] = '\0';
+        line_no++;
+        result = script_line(line, too_long, path, line_no, stop_on_error);
+    }
+
+    console_buffering(was_buffered);
+    script_depth--;
+    return result == 1;
+}
+
+// source [-e] <file>
+static int cmd_source(const char* args) {
+    // Nested commands reparse into cmd_buf/args_buf, so copy the path
+    char path[256];
+    int stop_on_error = 0;
+    int i = 0;
+    if (args[0] == '-' && args[1] == 'e' && (args[2] == ' ' || args[2] == '\t')) {
+        stop_on_error = 1;
+        i = 3;
+        while (args[i] == ' ' || args[i] == '\t') i++;
+    }
+    int j = 0;
+    while (args[i] && args[i] != ' ' && args[i] != '\t' && j < 255) path[j++] = args[i++];
+    path[j] = '\0';
+
+    if (j == 0) {
+        mt_print("source: missing file argument\n");
+        shell_status = 1;
+        return 0;
+    }
+    return shell_source(path, stop_on_error);
+}
+
 int shell_main(void) {
     cmd_clear();
     mt_print("BRIDGE v0.2 - PHOBOS\n");
@@ -696,81 +1727,28 @@ int shell_main(void) {
             continue;
         }
         
-        // Parse into command and arguments
-        parse_input(input);
-        
-        // Empty command (just whitespace)
-        if (cmd_buf[0] == '\0') {
-            continue;
-        }
-        
-        // Check for output redirection before pipeline/builtins
-        {
-            int redir_pos = 0;
-            int redir_mode = find_redirect(input, &redir_pos);
-            if (redir_mode > 0) {
-                exec_redirect(input, redir_pos, redir_mode);
-                continue;
-            }
-        }
-
-        // Check for pipeline before built-in command dispatch
-        if (has_pipe(input)) {
-            exec_pipeline(input);
-            continue;
-        }
-
-        // Handle built-in commands
-        if (str_eq(cmd_buf, "exit")) {
+        if (shell_execute(input)) {
             break;
-        } else if (str_eq(cmd_buf, "help")) {
-            cmd_help();
-        } else if (str_eq(cmd_buf, "pwd")) {
-            cmd_pwd();
-        } else if (str_eq(cmd_buf, "echo")) {
-            cmd_echo(args_buf);
-        } else if (str_eq(cmd_buf, "ls")) {
-            cmd_ls(args_buf);
-        } else if (str_eq(cmd_buf, "cd")) {
-            cmd_cd(args_buf);
-        } else if (str_eq(cmd_buf, "clear")) {
-            cmd_clear();
-        } else {
-            // Try to execute external program from /apps/<cmd>
-            char path_buf[256];
-            const char *path = cmd_buf;
-            if (cmd_buf[0] != '/') {
-                // default lookup in /apps
-                int i = 0;
-                const char *prefix = "/apps/";
-                while (prefix[i]) { path_buf[i] = prefix[i]; i++; }
-                int j = 0;
-                while (cmd_buf[j] && i < 255) { path_buf[i++] = cmd_buf[j++]; }
-                path_buf[i] = '\0';
-                path = path_buf;
-            }
-
-            // Build argv: prog, optional single arg string, NULL
-            char *argv[3];
-            argv[0] = (char *)cmd_buf;
-            argv[1] = (args_buf && args_buf[0] != '\0') ? (char *)args_buf : 0;
-            argv[2] = 0;
-
-            int r = exec_program(path, argv);
-            if (r == -127) {
-                mt_print("bridge: command not found: ");
-                mt_print(cmd_buf);
-                mt_print("\n");
-            } else if (r != 0) {
-                mt_print("bridge: ");
-                mt_print(cmd_buf);
-                mt_print(" exited with ");
-                print_int(r);
-                mt_print("\n");
-            }
         }
     }
     
     mt_print("Goodbye!\n");
     return 0;
 }
+
+// Batch entry point: bridge [-e] script.sh runs the script and returns the
+// status of its last command (or of the failing one with -e). Without a
+// script it starts the interactive shell.
+int shell_run(int argc, char **argv) {
+    int arg = 1;
+    int stop_on_error = 0;
+    if (arg < argc && str_eq(argv[arg], "-e")) {
+        stop_on_error = 1;
+        arg++;
+    }
+    if (arg >= argc) {
+        return shell_main();
+    }
+    shell_source(argv[arg], stop_on_error);
+    return shell_status;
+}